@@ -0,0 +1,438 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE: AttributeStore.cpp
+*  	DESCRIPTION: Implementation of the typed attribute columns
+*	URL: http://www.babelgraph.org/
+*/
+
+#include "AttributeStore.hpp"
+#include<cstdlib>
+#include<sstream>
+#include<iomanip>
+
+// The filters test 64 rows at a time and pack the answers into one word of
+// the result, with no branches in the inner loop so the compiler can
+// vectorize it.  Each comparison is a small functor so the loop is compiled
+// once per (column type, comparison) pair.
+namespace {
+
+struct Less { double v; bool operator()(double x) const { return x < v; } };
+struct LessEqual { double v; bool operator()(double x) const { return x <= v; } };
+struct Equal { double v; bool operator()(double x) const { return x == v; } };
+struct NotEqual { double v; bool operator()(double x) const { return x != v; } };
+struct GreaterEqual { double v; bool operator()(double x) const { return x >= v; } };
+struct Greater { double v; bool operator()(double x) const { return x > v; } };
+
+template <class T, class Test>
+void packTest(const T *values, int rows, Test test, const IDBitset &live, IDBitset &result)
+{
+	result = IDBitset(rows);
+	IDBitset::Word *out = result.data();
+	const IDBitset::Word *alive = live.data();
+
+	for (int w = 0; w < result.numWords(); w++)
+	{
+		int base = w * IDBitset::WORD_BITS;
+		int n = min((int) IDBitset::WORD_BITS, rows - base);
+		IDBitset::Word bits = 0;
+		for (int b = 0; b < n; b++)
+			bits |= (IDBitset::Word) test((double) values[base + b]) << b;
+		out[w] = bits & alive[w];
+	}
+}
+
+template <class T>
+void compareColumn(const T *values, int rows, AttributeStore::Compare op, double value, const IDBitset &live, IDBitset &result)
+{
+	switch (op)
+	{
+		case AttributeStore::LESS:
+		{ Less t = {value}; packTest(values, rows, t, live, result); break; }
+		case AttributeStore::LESS_EQUAL:
+		{ LessEqual t = {value}; packTest(values, rows, t, live, result); break; }
+		case AttributeStore::EQUAL:
+		{ Equal t = {value}; packTest(values, rows, t, live, result); break; }
+		case AttributeStore::NOT_EQUAL:
+		{ NotEqual t = {value}; packTest(values, rows, t, live, result); break; }
+		case AttributeStore::GREATER_EQUAL:
+		{ GreaterEqual t = {value}; packTest(values, rows, t, live, result); break; }
+		case AttributeStore::GREATER:
+		{ Greater t = {value}; packTest(values, rows, t, live, result); break; }
+	}
+}
+
+}
+
+//------------------------------------------------------------------------------
+AttributeStore::AttributeStore()
+{
+	clear();
+}
+//------------------------------------------------------------------------------
+int AttributeStore::addColumn(const string &name, Type type)
+{
+	int col = findColumn(name);
+	if (col >= 0)
+		return (columns[col].type == type) ? col : -1;
+
+	columns.push_back(Column());
+	columns.back().name = name;
+	columns.back().type = type;
+	resizeColumn(columns.back(), rows);
+	return columns.size() - 1;
+}
+//------------------------------------------------------------------------------
+int AttributeStore::findColumn(const string &name) const
+{
+	for (unsigned int c = 0; c < columns.size(); c++)
+	{
+		if (columns[c].name == name)
+			return c;
+	}
+	return -1;
+}
+//------------------------------------------------------------------------------
+void AttributeStore::removeColumn(int col)
+{
+	if ((col >= 0) && (col < (int) columns.size()))
+		columns.erase(columns.begin() + col);
+}
+//------------------------------------------------------------------------------
+int AttributeStore::getNumColumns() const
+{
+	return columns.size();
+}
+//------------------------------------------------------------------------------
+string AttributeStore::getColumnName(int col) const
+{
+	return columns[col].name;
+}
+//------------------------------------------------------------------------------
+AttributeStore::Type AttributeStore::getColumnType(int col) const
+{
+	return columns[col].type;
+}
+//------------------------------------------------------------------------------
+const char * AttributeStore::typeName(Type type)
+{
+	static const char *names[] = {"int32", "float", "double", "string"};
+	return names[type];
+}
+//------------------------------------------------------------------------------
+bool AttributeStore::parseType(const string &name, Type &type)
+{
+	for (int t = INT32; t <= STRING; t++)
+	{
+		if (name == typeName((Type) t))
+		{
+			type = (Type) t;
+			return true;
+		}
+	}
+	return false;
+}
+//------------------------------------------------------------------------------
+void AttributeStore::addRow(int id)
+{
+	if (id >= rows)
+	{
+		rows = id + 1;
+		live.resize(rows);
+		for (unsigned int c = 0; c < columns.size(); c++)
+			resizeColumn(columns[c], rows);
+	}
+	live.set(id);
+}
+//------------------------------------------------------------------------------
+void AttributeStore::removeRow(int id)
+{
+	if (!isLive(id))
+		return;
+
+	// back to the defaults, ready for the ID to be reused
+	for (unsigned int c = 0; c < columns.size(); c++)
+		resetValue(columns[c], id);
+	live.reset(id);
+}
+//------------------------------------------------------------------------------
+bool AttributeStore::isLive(int id) const
+{
+	return live.test(id);
+}
+//------------------------------------------------------------------------------
+int AttributeStore::getRowLimit() const
+{
+	return rows;
+}
+//------------------------------------------------------------------------------
+void AttributeStore::clearRows()
+{
+	rows = 0;
+	live.resize(0);
+	for (unsigned int c = 0; c < columns.size(); c++)
+		resizeColumn(columns[c], 0);
+}
+//------------------------------------------------------------------------------
+void AttributeStore::clear()
+{
+	columns.clear();
+	rows = 0;
+	live.resize(0);
+	strings.clear();
+	strings.intern("");		// handle 0, the default for string columns
+}
+//------------------------------------------------------------------------------
+double AttributeStore::getNumber(int col, int id) const
+{
+	if (!isLive(id))
+		return 0;
+
+	const Column &c = columns[col];
+	switch (c.type)
+	{
+		case INT32:		return c.ints[id];
+		case FLOAT:		return c.floats[id];
+		case DOUBLE:	return c.doubles[id];
+		default:		return 0;
+	}
+}
+//------------------------------------------------------------------------------
+void AttributeStore::setNumber(int col, int id, double value)
+{
+	if (!isLive(id))
+		return;
+
+	Column &c = columns[col];
+	switch (c.type)
+	{
+		case INT32:		c.ints[id] = (int) value; break;
+		case FLOAT:		c.floats[id] = value; break;
+		case DOUBLE:	c.doubles[id] = value; break;
+		default:		break;
+	}
+}
+//------------------------------------------------------------------------------
+string AttributeStore::getString(int col, int id) const
+{
+	if (!isLive(id) || (columns[col].type != STRING))
+		return "";
+
+	return strings.get(columns[col].handles[id]);
+}
+//------------------------------------------------------------------------------
+void AttributeStore::setString(int col, int id, const string &value)
+{
+	if (!isLive(id) || (columns[col].type != STRING))
+		return;
+
+	columns[col].handles[id] = strings.intern(value);
+}
+//------------------------------------------------------------------------------
+string AttributeStore::getText(int col, int id) const
+{
+	// enough digits that reading the text back gives the same value
+	ostringstream text;
+	switch (columns[col].type)
+	{
+		case INT32:		text << (int) getNumber(col, id); break;
+		case FLOAT:		text << setprecision(9) << (float) getNumber(col, id); break;
+		case DOUBLE:	text << setprecision(17) << getNumber(col, id); break;
+		case STRING:	return getString(col, id);
+	}
+	return text.str();
+}
+//------------------------------------------------------------------------------
+void AttributeStore::setText(int col, int id, const string &text)
+{
+	switch (columns[col].type)
+	{
+		case INT32:		setNumber(col, id, atoi(text.c_str())); break;
+		case FLOAT:
+		case DOUBLE:	setNumber(col, id, strtod(text.c_str(), NULL)); break;
+		case STRING:	setString(col, id, text); break;
+	}
+}
+//------------------------------------------------------------------------------
+void AttributeStore::getNumbers(int col, const vector<int> &ids, vector<double> &values) const
+{
+	values.resize(ids.size());
+	for (unsigned int i = 0; i < ids.size(); i++)
+		values[i] = getNumber(col, ids[i]);
+}
+//------------------------------------------------------------------------------
+void AttributeStore::setNumbers(int col, const vector<int> &ids, const vector<double> &values)
+{
+	for (unsigned int i = 0; (i < ids.size()) && (i < values.size()); i++)
+		setNumber(col, ids[i], values[i]);
+}
+//------------------------------------------------------------------------------
+void AttributeStore::getStrings(int col, const vector<int> &ids, vector<string> &values) const
+{
+	values.resize(ids.size());
+	for (unsigned int i = 0; i < ids.size(); i++)
+		values[i] = getString(col, ids[i]);
+}
+//------------------------------------------------------------------------------
+void AttributeStore::setStrings(int col, const vector<int> &ids, const vector<string> &values)
+{
+	for (unsigned int i = 0; (i < ids.size()) && (i < values.size()); i++)
+		setString(col, ids[i], values[i]);
+}
+//------------------------------------------------------------------------------
+int * AttributeStore::intData(int col)
+{
+	Column &c = columns[col];
+	return ((c.type == INT32) && rows) ? &c.ints[0] : NULL;
+}
+//------------------------------------------------------------------------------
+float * AttributeStore::floatData(int col)
+{
+	Column &c = columns[col];
+	return ((c.type == FLOAT) && rows) ? &c.floats[0] : NULL;
+}
+//------------------------------------------------------------------------------
+double * AttributeStore::doubleData(int col)
+{
+	Column &c = columns[col];
+	return ((c.type == DOUBLE) && rows) ? &c.doubles[0] : NULL;
+}
+//------------------------------------------------------------------------------
+const unsigned int * AttributeStore::stringHandles(int col) const
+{
+	const Column &c = columns[col];
+	return ((c.type == STRING) && rows) ? &c.handles[0] : NULL;
+}
+//------------------------------------------------------------------------------
+const StringPool & AttributeStore::getStringPool() const
+{
+	return strings;
+}
+//------------------------------------------------------------------------------
+void AttributeStore::filter(int col, Compare op, double value, IDBitset &result) const
+{
+	const Column &c = columns[col];
+	switch (c.type)
+	{
+		case INT32:		compareColumn(c.ints.data(), rows, op, value, live, result); break;
+		case FLOAT:		compareColumn(c.floats.data(), rows, op, value, live, result); break;
+		case DOUBLE:	compareColumn(c.doubles.data(), rows, op, value, live, result); break;
+		case STRING:	result = IDBitset(rows); break;		// numbers never match a string
+	}
+}
+//------------------------------------------------------------------------------
+void AttributeStore::filter(int col, Compare op, const string &value, IDBitset &result) const
+{
+	const Column &c = columns[col];
+	if ((c.type != STRING) || ((op != EQUAL) && (op != NOT_EQUAL)))
+	{
+		result = IDBitset(rows);
+		return;
+	}
+
+	// equal strings share a handle, so this is an integer comparison; a
+	// string that was never interned matches nothing
+	unsigned int handle = strings.find(value);
+	double key = (handle == (unsigned int) StringPool::NOT_FOUND) ? -1.0 : (double) handle;
+	compareColumn(c.handles.data(), rows, op, key, live, result);
+}
+//------------------------------------------------------------------------------
+void AttributeStore::write(ostream &out, const string &section) const
+{
+	for (unsigned int c = 0; c < columns.size(); c++)
+	{
+		out << section << " " << typeName(columns[c].type) << " " << columns[c].name << "\n";
+		for (int id = 0; id < rows; id++)
+		{
+			if (isLive(id))
+				out << id << "," << escape(getText(c, id)) << "\n";
+		}
+	}
+}
+//------------------------------------------------------------------------------
+string AttributeStore::escape(const string &text)
+{
+	string escaped;
+	escaped.reserve(text.size());
+	for (unsigned int i = 0; i < text.size(); i++)
+	{
+		switch (text[i])
+		{
+			case '\\':	escaped += "\\\\"; break;
+			case '\n':	escaped += "\\n"; break;
+			case '\r':	escaped += "\\r"; break;
+			case ',':	escaped += "\\,"; break;
+			default:	escaped += text[i];
+		}
+	}
+	return escaped;
+}
+//------------------------------------------------------------------------------
+string AttributeStore::unescape(const string &text)
+{
+	// anything else after a backslash stands for itself
+	string plain;
+	plain.reserve(text.size());
+	for (unsigned int i = 0; i < text.size(); i++)
+	{
+		if ((text[i] != '\\') || (i + 1 == text.size()))
+		{
+			plain += text[i];
+			continue;
+		}
+		i++;
+		if (text[i] == 'n')
+			plain += '\n';
+		else if (text[i] == 'r')
+			plain += '\r';
+		else
+			plain += text[i];
+	}
+	return plain;
+}
+//------------------------------------------------------------------------------
+size_t AttributeStore::bytes() const
+{
+	size_t total = live.numWords() * sizeof(IDBitset::Word) + strings.bytes();
+	for (unsigned int c = 0; c < columns.size(); c++)
+	{
+		const Column &col = columns[c];
+		total += col.ints.capacity() * sizeof(int) + col.floats.capacity() * sizeof(float)
+			+ col.doubles.capacity() * sizeof(double) + col.handles.capacity() * sizeof(unsigned int);
+	}
+	return total;
+}
+//------------------------------------------------------------------------------
+void AttributeStore::resizeColumn(Column &c, int numRows)
+{
+	// new rows get the default value
+	switch (c.type)
+	{
+		case INT32:		c.ints.resize(numRows, 0); break;
+		case FLOAT:		c.floats.resize(numRows, 0); break;
+		case DOUBLE:	c.doubles.resize(numRows, 0); break;
+		case STRING:	c.handles.resize(numRows, 0); break;
+	}
+}
+//------------------------------------------------------------------------------
+void AttributeStore::resetValue(Column &c, int id)
+{
+	switch (c.type)
+	{
+		case INT32:		c.ints[id] = 0; break;
+		case FLOAT:		c.floats[id] = 0; break;
+		case DOUBLE:	c.doubles[id] = 0; break;
+		case STRING:	c.handles[id] = 0; break;
+	}
+}
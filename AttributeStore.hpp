@@ -0,0 +1,129 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE:  AttributeStore.hpp
+*  	DESCRIPTION:  Header file for the named, typed attribute columns of the
+*					vertices or edges of a NiceGraph
+*	URL: http://www.babelgraph.org/
+*/
+
+#ifndef ATTRIBUTESTORE_HPP_
+#define ATTRIBUTESTORE_HPP_
+
+#include<string>
+#include<vector>
+#include<iostream>
+
+#include "IDBitset.hpp"
+#include "StringPool.hpp"
+
+using namespace std;
+
+// An AttributeStore keeps any number of named columns, each one a plain
+// array with one value per vertex (or edge) ID.  Numeric columns hold int,
+// float or double values; string columns hold StringPool handles, so equal
+// strings are stored once and compare as integers.
+//
+// The owning NiceGraph calls addRow() and removeRow() as IDs come and go.  A
+// new row starts out as 0 (or "") in every column, and so does a reused ID.
+// Values of rows that aren't live are kept at that default and never show
+// up in a filter().
+
+class AttributeStore {
+
+	public:
+	AttributeStore();
+
+	enum Type {INT32 = 0, FLOAT, DOUBLE, STRING};
+	enum Compare {LESS = 0, LESS_EQUAL, EQUAL, NOT_EQUAL, GREATER_EQUAL, GREATER};
+
+	// Columns
+	int addColumn(const string &name, Type type);	// returns the column, or -1 if the name is taken by another type
+	int findColumn(const string &name) const;		// returns -1 if there is no such column
+	void removeColumn(int col);
+	int getNumColumns() const;
+	string getColumnName(int col) const;
+	Type getColumnType(int col) const;
+	static const char * typeName(Type type);
+	static bool parseType(const string &name, Type &type);
+
+	// Rows, indexed by ID
+	void addRow(int id);
+	void removeRow(int id);
+	bool isLive(int id) const;
+	int getRowLimit() const;	// one past the largest row ever added
+	void clearRows();			// keeps the columns
+	void clear();				// drops the columns too
+
+	// Single values; numeric columns convert between their types, string
+	// columns only take the string calls
+	double getNumber(int col, int id) const;
+	void setNumber(int col, int id, double value);
+	string getString(int col, int id) const;
+	void setString(int col, int id, const string &value);
+
+	// Any type as text, for files
+	string getText(int col, int id) const;
+	void setText(int col, int id, const string &text);
+
+	// Bulk access, values[i] goes with ids[i]
+	void getNumbers(int col, const vector<int> &ids, vector<double> &values) const;
+	void setNumbers(int col, const vector<int> &ids, const vector<double> &values);
+	void getStrings(int col, const vector<int> &ids, vector<string> &values) const;
+	void setStrings(int col, const vector<int> &ids, const vector<string> &values);
+
+	// Whole columns indexed by ID below getRowLimit(), NULL if the column has
+	// another type.  The pointers are only good until the next addRow().
+	int * intData(int col);
+	float * floatData(int col);
+	double * doubleData(int col);
+	const unsigned int * stringHandles(int col) const;
+	const StringPool & getStringPool() const;
+
+	// Live rows whose value passes the test, as a set sized getRowLimit().
+	// String columns only support EQUAL and NOT_EQUAL.
+	void filter(int col, Compare op, double value, IDBitset &result) const;
+	void filter(int col, Compare op, const string &value, IDBitset &result) const;
+
+	// One "<section> <type> <name>" header per column followed by "id,value"
+	// lines for the live rows (see NiceGraph::saveToFile()).  The values are
+	// escaped, so a string with a newline still takes one line; the reader
+	// passes them through unescape().
+	void write(ostream &out, const string &section) const;
+	static string escape(const string &text);		// backslash, newline, return and comma as \\, \n, \r and \,
+	static string unescape(const string &text);
+
+	size_t bytes() const;	// memory held, in bytes
+
+	private:
+	struct Column {
+		string name;
+		Type type;
+		vector<int> ints;			// only the vector for the column's type is used
+		vector<float> floats;
+		vector<double> doubles;
+		vector<unsigned int> handles;
+	};
+
+	vector<Column> columns;
+	IDBitset live;
+	int rows;
+	StringPool strings;
+
+	void resizeColumn(Column &c, int numRows);
+	void resetValue(Column &c, int id);
+
+};
+
+#endif // ATTRIBUTESTORE_HPP_
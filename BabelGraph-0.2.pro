@@ -10,14 +10,52 @@ QT += opengl
 SUBDIRS += src
 RESOURCES = BG_resources.qrc
 
+# the analyses spread their loops over all cores with OpenMP; without it
+# they still build and run, on one thread
+unix|win32-g++ {
+    QMAKE_CXXFLAGS += -fopenmp
+    LIBS += -fopenmp
+}
+win32-msvc* {
+    QMAKE_CXXFLAGS += -openmp
+}
+
 # Input
 HEADERS += GraphWidget.hpp \
            kregulargraphdialog.hpp \
            MainWindow.hpp \
            randomgraphdialog.hpp \
            strangersbanquetgraphdialog.hpp \
-           NiceGraph.hpp
+           NiceGraph.hpp \
+           GraphSnapshot.hpp \
+           SlotVector.hpp \
+           EdgeIndex.hpp \
+           NodePool.hpp \
+           PositionBuffer.hpp \
+           StringPool.hpp \
+           IDBitset.hpp \
+           AttributeStore.hpp \
+           CompressedGraph.hpp \
+           GraphKernels.hpp \
+           MappedGraph.hpp \
+           GraphJournal.hpp \
+           BitMatrix.hpp \
+           DistanceMatrix.hpp \
+           PersonalizedPageRank.hpp \
+           IncrementalPageRank.hpp
 SOURCES += GraphWidget.cpp \
            main.cpp \
            MainWindow.cpp \
-           NiceGraph.cpp
+           NiceGraph.cpp \
+           GraphSnapshot.cpp \
+           EdgeIndex.cpp \
+           PositionBuffer.cpp \
+           StringPool.cpp \
+           AttributeStore.cpp \
+           CompressedGraph.cpp \
+           MappedGraph.cpp \
+           GraphJournal.cpp \
+           BitMatrix.cpp \
+           DistanceMatrix.cpp \
+           PersonalizedPageRank.cpp \
+           IncrementalPageRank.cpp
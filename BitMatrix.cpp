@@ -0,0 +1,213 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE: BitMatrix.cpp
+*  	DESCRIPTION: Implementation of the bit adjacency matrix
+*	URL: http://www.babelgraph.org/
+*/
+
+#include "BitMatrix.hpp"
+#include "GraphSnapshot.hpp"
+
+//------------------------------------------------------------------------------
+BitMatrix::BitMatrix()
+{
+	clear();
+}
+//------------------------------------------------------------------------------
+bool BitMatrix::worthBuilding(int numVertices, long long numArcs)
+{
+	return (numVertices > 0) && (numVertices <= MAX_VERTICES)
+		&& (numArcs * DENSITY_DIVISOR >= (long long) numVertices * (numVertices - 1));
+}
+//------------------------------------------------------------------------------
+void BitMatrix::build(const GraphSnapshot &snapshot)
+{
+	n = snapshot.getNumVertices();
+	words = (n + WORD_BITS - 1) / WORD_BITS;
+	numArcs = snapshot.getNumEdges();
+	out.assign((size_t) n * words, 0);
+	in.assign((size_t) n * words, 0);
+	outDegrees.resize(n);
+	inDegrees.resize(n);
+
+	for (int v = 0; v < n; v++)
+	{
+		Word *row = &out[(size_t) v * words];
+		for (const int *u = snapshot.outBegin(v); u != snapshot.outEnd(v); u++)
+			row[*u / WORD_BITS] |= (Word) 1 << (*u % WORD_BITS);
+		outDegrees[v] = snapshot.getOutDegree(v);
+
+		row = &in[(size_t) v * words];
+		for (const int *u = snapshot.inBegin(v); u != snapshot.inEnd(v); u++)
+			row[*u / WORD_BITS] |= (Word) 1 << (*u % WORD_BITS);
+		inDegrees[v] = snapshot.getInDegree(v);
+	}
+}
+//------------------------------------------------------------------------------
+void BitMatrix::clear()
+{
+	n = words = numArcs = 0;
+	vector<Word>().swap(out);
+	vector<Word>().swap(in);
+	outDegrees.clear();
+	inDegrees.clear();
+}
+//------------------------------------------------------------------------------
+bool BitMatrix::empty() const
+{
+	return n == 0;
+}
+//------------------------------------------------------------------------------
+int BitMatrix::getNumVertices() const
+{
+	return n;
+}
+//------------------------------------------------------------------------------
+int BitMatrix::getNumEdges() const
+{
+	return numArcs;
+}
+//------------------------------------------------------------------------------
+bool BitMatrix::testFromToConnected(int from, int to) const
+{
+	return (outBits(from)[to / WORD_BITS] >> (to % WORD_BITS)) & 1;
+}
+//------------------------------------------------------------------------------
+int BitMatrix::countAnd(const Word *a, const Word *b, int fromBit) const
+{
+	int w = fromBit / WORD_BITS;
+	if (w >= words)
+		return 0;
+
+	int count = IDBitset::popcount(a[w] & b[w] & (~(Word) 0 << (fromBit % WORD_BITS)));
+	for (w++; w < words; w++)
+		count += IDBitset::popcount(a[w] & b[w]);
+	return count;
+}
+//------------------------------------------------------------------------------
+float BitMatrix::clusteringCoefficient(int v) const
+{
+	// the neighborhood is the union of the in and out rows; each neighbor's
+	// out row ANDed with it gives that neighbor's links inside it.  There are
+	// no self loops, so no bits need masking off.
+	vector<Word> ns (words);
+	const Word *o = outBits(v), *i = inBits(v);
+	int size = 0;
+	for (int w = 0; w < words; w++)
+	{
+		ns[w] = o[w] | i[w];
+		size += IDBitset::popcount(ns[w]);
+	}
+
+	int max = size * (size - 1);
+	if (max < 1)
+		return 0;
+
+	int cnxs = 0;
+	Row neighbors (&ns[0], words);
+	for (Row::const_iterator u = neighbors.begin(); u != neighbors.end(); ++u)
+		cnxs += countAnd(outBits(*u), &ns[0], 0);
+
+	return (float)cnxs / (float)max;
+}
+//------------------------------------------------------------------------------
+long long BitMatrix::countTriangles() const
+{
+	// each triangle v < u < w once, from v: the common neighbors of v and u
+	// above u
+	long long triangles = 0;
+	for (int v = 0; v < n; v++)
+	{
+		const Word *vRow = outBits(v);
+		Row vs = outRow(v);
+		for (Row::const_iterator u = vs.begin(); u != vs.end(); ++u)
+		{
+			if (*u > v)
+				triangles += countAnd(vRow, outBits(*u), *u + 1);
+		}
+	}
+	return triangles;
+}
+//------------------------------------------------------------------------------
+void BitMatrix::bfsDistances(int source, vector<int> &distance) const
+{
+	// Level by level with the frontier as a bit set.  While the frontier is
+	// small its out rows are ORed together (top down); once it outnumbers
+	// the vertices still unvisited, each of those checks its in row against
+	// the frontier instead and stops at the first hit (bottom up).
+	distance.assign(n, -1);
+	distance[source] = 0;
+
+	vector<Word> frontier (words, 0), next (words, 0), unvisited (words, ~(Word) 0);
+	if (n % WORD_BITS)
+		unvisited[words - 1] = ((Word) 1 << (n % WORD_BITS)) - 1;
+	frontier[source / WORD_BITS] |= (Word) 1 << (source % WORD_BITS);
+	unvisited[source / WORD_BITS] &= ~((Word) 1 << (source % WORD_BITS));
+
+	int frontierSize = 1, remaining = n - 1;
+	for (int level = 1; (frontierSize > 0) && (remaining > 0); level++)
+	{
+		next.assign(words, 0);
+
+		if (frontierSize < remaining)
+		{
+			Row f (&frontier[0], words);
+			for (Row::const_iterator u = f.begin(); u != f.end(); ++u)
+			{
+				const Word *row = outBits(*u);
+				for (int w = 0; w < words; w++)
+					next[w] |= row[w];
+			}
+			for (int w = 0; w < words; w++)
+				next[w] &= unvisited[w];
+		}
+		else
+		{
+			Row left (&unvisited[0], words);
+			for (Row::const_iterator v = left.begin(); v != left.end(); ++v)
+			{
+				const Word *row = inBits(*v);
+				for (int w = 0; w < words; w++)
+				{
+					if (row[w] & frontier[w])
+					{
+						next[*v / WORD_BITS] |= (Word) 1 << (*v % WORD_BITS);
+						break;
+					}
+				}
+			}
+		}
+
+		frontierSize = 0;
+		for (int w = 0; w < words; w++)
+		{
+			unvisited[w] &= ~next[w];
+			frontierSize += IDBitset::popcount(next[w]);
+		}
+		remaining -= frontierSize;
+
+		Row reached (&next[0], words);
+		for (Row::const_iterator v = reached.begin(); v != reached.end(); ++v)
+			distance[*v] = level;
+
+		frontier.swap(next);
+	}
+}
+//------------------------------------------------------------------------------
+size_t BitMatrix::bytes() const
+{
+	return (out.capacity() + in.capacity()) * sizeof(Word)
+		+ (outDegrees.capacity() + inDegrees.capacity()) * sizeof(int);
+}
@@ -0,0 +1,152 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE:  BitMatrix.hpp
+*  	DESCRIPTION:  Header file for a bit adjacency matrix, the layout used
+*					for dense graphs
+*	URL: http://www.babelgraph.org/
+*/
+
+#ifndef BITMATRIX_HPP_
+#define BITMATRIX_HPP_
+
+#include<vector>
+#include<cstddef>
+#include<iterator>
+
+#include "IDBitset.hpp"
+
+using namespace std;
+
+class GraphSnapshot;
+
+// A BitMatrix keeps the adjacency matrix of a graph one bit per pair: row v
+// has bit u set if there is an arc v->u, and a second matrix holds the in
+// rows.  Rows are padded to whole 64 bit words, so two neighborhoods are
+// intersected a word at a time and counted with popcount instead of being
+// merged element by element.
+//
+// At n^2/4 bytes for both matrices this only pays on dense graphs.  The
+// snapshot spends 12 bytes per arc (out neighbor, weight, in neighbor), so
+// from a density of 1/16 on the bits add at most a third to it, while a
+// word-wise intersection reads n/64 words where a merge reads upwards of
+// n/8 neighbors.  GraphSnapshot builds one alongside its rows when
+// worthBuilding() says so and hands the kernels below the work.
+//
+// Rows are also readable as ranges of set bits, so the kernels in
+// GraphKernels.hpp run on it unchanged.  All indices are dense, as in the
+// snapshot it was built from.
+
+class BitMatrix {
+
+	public:
+	typedef IDBitset::Word Word;
+	enum {WORD_BITS = IDBitset::WORD_BITS};
+	enum {MAX_VERTICES = 16384, DENSITY_DIVISOR = 16};	// 64 MB at most
+
+	BitMatrix();
+
+	static bool worthBuilding(int numVertices, long long numArcs);
+	void build(const GraphSnapshot &snapshot);
+	void clear();
+	bool empty() const;
+
+	// Sizes
+	int getNumVertices() const;
+	int getNumEdges() const;		// directed arcs, like GraphSnapshot
+	int getOutDegree(int v) const { return outDegrees[v]; }
+	int getInDegree(int v) const { return inDegrees[v]; }
+	bool testFromToConnected(int from, int to) const;
+
+	// Raw rows, rowWords() words each
+	int rowWords() const { return words; }
+	const Word * outBits(int v) const { return &out[(size_t) v * words]; }
+	const Word * inBits(int v) const { return &in[(size_t) v * words]; }
+
+	// Rows as ranges of neighbors in increasing order
+	class Row {
+		public:
+		class const_iterator {
+			public:
+			typedef forward_iterator_tag iterator_category;
+			typedef int value_type;
+			typedef ptrdiff_t difference_type;
+			typedef const int * pointer;
+			typedef int reference;
+
+			const_iterator() : bits(NULL), w(0), last(0), current(0) {}
+			const_iterator(const Word *row, int numWords) : bits(row), w(0), last(numWords), current(0)
+			{
+				if (last > 0)
+					current = bits[0];
+				settle();
+			}
+
+			int operator*() const { return w * WORD_BITS + IDBitset::lowestBit(current); }
+			const_iterator & operator++()
+			{
+				current &= current - 1;
+				settle();
+				return *this;
+			}
+			const_iterator operator++(int) { const_iterator old = *this; ++(*this); return old; }
+			// only iterators over the same row are ever compared; the end is
+			// where the words run out
+			bool operator==(const const_iterator &other) const { return (w == other.w) && (current == other.current); }
+			bool operator!=(const const_iterator &other) const { return !(*this == other); }
+
+			private:
+			friend class Row;
+			void settle()
+			{
+				while ((current == 0) && (w + 1 < last))
+					current = bits[++w];
+				if (current == 0)
+					w = last;
+			}
+
+			const Word *bits;
+			int w, last;
+			Word current;
+		};
+
+		Row(const Word *row, int numWords) : start(row), size(numWords) {}
+		const_iterator begin() const { return const_iterator(start, size); }
+		const_iterator end() const { const_iterator e; e.w = size; return e; }
+
+		private:
+		const Word *start;
+		int size;
+	};
+
+	Row outRow(int v) const { return Row(outBits(v), words); }
+	Row inRow(int v) const { return Row(inBits(v), words); }
+
+	// Analyses, the same answers as the GraphSnapshot ones
+	float clusteringCoefficient(int v) const;
+	long long countTriangles() const;		// reads the out rows as neighbor sets, see GraphKernels
+	void bfsDistances(int source, vector<int> &distance) const;
+
+	size_t bytes() const;	// memory held, in bytes
+
+	private:
+	int n, words, numArcs;
+	vector<Word> out, in;
+	vector<int> outDegrees, inDegrees;
+
+	int countAnd(const Word *a, const Word *b, int fromBit) const;	// bits set in both, from fromBit on
+
+};
+
+#endif // BITMATRIX_HPP_
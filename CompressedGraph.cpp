@@ -0,0 +1,168 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE: CompressedGraph.cpp
+*  	DESCRIPTION: Implementation of the gap encoded read-only graph
+*	URL: http://www.babelgraph.org/
+*/
+
+#include "CompressedGraph.hpp"
+#include "GraphSnapshot.hpp"
+
+//------------------------------------------------------------------------------
+CompressedGraph::CompressedGraph()
+{
+	numArcs = 0;
+}
+//------------------------------------------------------------------------------
+CompressedGraph::CompressedGraph(const GraphSnapshot &snapshot)
+{
+	build(snapshot);
+}
+//------------------------------------------------------------------------------
+void CompressedGraph::build(const GraphSnapshot &snapshot)
+{
+	int size = snapshot.getNumVertices();
+	numArcs = snapshot.getNumEdges();
+
+	resize(size);
+
+	for (int v = 0; v < size; v++)
+	{
+		denseToVID[v] = snapshot.getVID(v);
+		outDegrees[v] = snapshot.getOutDegree(v);
+		outOffsets[v] = outBytes.size();
+		encodeRow(outBytes, snapshot.outBegin(v), snapshot.outEnd(v));
+		inDegrees[v] = snapshot.getInDegree(v);
+		inOffsets[v] = inBytes.size();
+		encodeRow(inBytes, snapshot.inBegin(v), snapshot.inEnd(v));
+	}
+
+	// give back the slack left by growing the arrays
+	vector<unsigned char>(outBytes).swap(outBytes);
+	vector<unsigned char>(inBytes).swap(inBytes);
+}
+//------------------------------------------------------------------------------
+void CompressedGraph::build(int numVertices, vector<pair<int,int> > &arcs)
+{
+	sort(arcs.begin(), arcs.end());
+	arcs.erase(unique(arcs.begin(), arcs.end()), arcs.end());
+	numArcs = arcs.size();
+
+	resize(numVertices);
+	for (int v = 0; v < numVertices; v++)
+		denseToVID[v] = v;
+
+	// the out rows come straight from the sorted pairs, the in rows from the
+	// same pairs flipped around and sorted again
+	vector<int> row;
+	for (int pass = 0; pass < 2; pass++)
+	{
+		vector<unsigned char> &bytes = (pass == 0) ? outBytes : inBytes;
+		vector<size_t> &offsets = (pass == 0) ? outOffsets : inOffsets;
+		vector<int> &degrees = (pass == 0) ? outDegrees : inDegrees;
+
+		unsigned int a = 0;
+		for (int v = 0; v < numVertices; v++)
+		{
+			row.clear();
+			for (; (a < arcs.size()) && (arcs[a].first == v); a++)
+				row.push_back(arcs[a].second);
+			degrees[v] = row.size();
+			offsets[v] = bytes.size();
+			encodeRow(bytes, row.empty() ? NULL : &row[0], row.empty() ? NULL : &row[0] + row.size());
+		}
+		vector<unsigned char>(bytes).swap(bytes);
+
+		for (unsigned int f = 0; f < arcs.size(); f++)
+			swap(arcs[f].first, arcs[f].second);
+		sort(arcs.begin(), arcs.end());
+	}
+}
+//------------------------------------------------------------------------------
+void CompressedGraph::clear()
+{
+	numArcs = 0;
+	vector<unsigned char>().swap(outBytes);
+	vector<unsigned char>().swap(inBytes);
+	outOffsets.clear();
+	inOffsets.clear();
+	outDegrees.clear();
+	inDegrees.clear();
+	denseToVID.clear();
+}
+//------------------------------------------------------------------------------
+bool CompressedGraph::empty() const
+{
+	return outOffsets.empty();
+}
+//------------------------------------------------------------------------------
+int CompressedGraph::getNumVertices() const
+{
+	return outOffsets.size();
+}
+//------------------------------------------------------------------------------
+int CompressedGraph::getNumEdges() const
+{
+	return numArcs;
+}
+//------------------------------------------------------------------------------
+int CompressedGraph::getVID(int denseIndex) const
+{
+	return denseToVID[denseIndex];
+}
+//------------------------------------------------------------------------------
+size_t CompressedGraph::bytes() const
+{
+	return outBytes.capacity() + inBytes.capacity()
+		+ (outOffsets.capacity() + inOffsets.capacity()) * sizeof(size_t)
+		+ (outDegrees.capacity() + inDegrees.capacity() + denseToVID.capacity()) * sizeof(int);
+}
+//------------------------------------------------------------------------------
+double CompressedGraph::bytesPerEdge() const
+{
+	return (numArcs > 0) ? (double) bytes() / numArcs : 0;
+}
+//------------------------------------------------------------------------------
+void CompressedGraph::encode(vector<unsigned char> &bytes, unsigned int x)
+{
+	while (x >= 0x80)
+	{
+		bytes.push_back((unsigned char)(x | 0x80));
+		x >>= 7;
+	}
+	bytes.push_back((unsigned char) x);
+}
+//------------------------------------------------------------------------------
+void CompressedGraph::encodeRow(vector<unsigned char> &bytes, const int *first, const int *last)
+{
+	// first neighbor, then the gaps (rows are sorted, so they're positive)
+	int previous = 0;
+	for (const int *n = first; n != last; n++)
+	{
+		encode(bytes, *n - previous);
+		previous = *n;
+	}
+}
+//------------------------------------------------------------------------------
+void CompressedGraph::resize(int numVertices)
+{
+	outBytes.clear();
+	inBytes.clear();
+	outOffsets.resize(numVertices);
+	inOffsets.resize(numVertices);
+	outDegrees.resize(numVertices);
+	inDegrees.resize(numVertices);
+	denseToVID.resize(numVertices);
+}
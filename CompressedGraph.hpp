@@ -0,0 +1,142 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE:  CompressedGraph.hpp
+*  	DESCRIPTION:  Header file for a read-only graph whose neighbor rows are
+*					gap encoded as variable length integers
+*	URL: http://www.babelgraph.org/
+*/
+
+#ifndef COMPRESSEDGRAPH_HPP_
+#define COMPRESSEDGRAPH_HPP_
+
+#include<vector>
+#include<cstddef>
+#include<iterator>
+
+using namespace std;
+
+class GraphSnapshot;
+
+// A CompressedGraph holds the same rows as a GraphSnapshot, but packed.
+// Each row is the first neighbor followed by the gaps between consecutive
+// neighbors; every number is written 7 bits to a byte with the high bit set
+// on all but the last byte.  Since rows are sorted and neighbors tend to be
+// close together, most gaps take a single byte, against 4 for an int in the
+// snapshot and far more for a map node.  The row lengths are kept in plain
+// arrays, since PageRank looks them up for every edge.
+//
+// Rows are decoded on the fly by Row::const_iterator, so the kernels in
+// GraphKernels.hpp run on it unchanged.  There are no edge weights; it is
+// meant for the unweighted analyses (BFS, PageRank, triangles) on graphs
+// too big to keep in the other forms.  GraphSnapshot builds one alongside
+// its rows when NiceGraph::setCompressedRows() asks for it and then runs
+// those analyses on the packed rows, which read fewer bytes per arc.
+
+class CompressedGraph {
+
+	public:
+	CompressedGraph();
+	CompressedGraph(const GraphSnapshot &snapshot);
+
+	void build(const GraphSnapshot &snapshot);
+	// from (from, to) pairs of dense indices below numVertices; the pairs are
+	// sorted in place and repeats are dropped
+	void build(int numVertices, vector<pair<int,int> > &arcs);
+	void clear();
+	bool empty() const;
+
+	// Sizes
+	int getNumVertices() const;
+	int getNumEdges() const;		// directed arcs, like GraphSnapshot
+	int getVID(int denseIndex) const;
+
+	class Row {
+		public:
+		class const_iterator {
+			public:
+			typedef forward_iterator_tag iterator_category;
+			typedef int value_type;
+			typedef ptrdiff_t difference_type;
+			typedef const int * pointer;
+			typedef const int & reference;
+
+			const_iterator() : next(NULL), remaining(0), value(0) {}
+			const_iterator(const unsigned char *row, int length) : next(row), remaining(length), value(0)
+			{
+				if (remaining > 0)
+					value = decode(next);
+			}
+
+			const int & operator*() const { return value; }
+			const_iterator & operator++()
+			{
+				if (--remaining > 0)
+					value += decode(next);
+				return *this;
+			}
+			const_iterator operator++(int) { const_iterator old = *this; ++(*this); return old; }
+			// only iterators over the same row are ever compared
+			bool operator==(const const_iterator &other) const { return remaining == other.remaining; }
+			bool operator!=(const const_iterator &other) const { return remaining != other.remaining; }
+
+			private:
+			const unsigned char *next;
+			int remaining, value;
+		};
+
+		Row(const unsigned char *row, int length) : start(row), size(length) {}
+		const_iterator begin() const { return const_iterator(start, size); }
+		const_iterator end() const { return const_iterator(); }
+
+		private:
+		const unsigned char *start;
+		int size;
+	};
+
+	Row outRow(int v) const { return Row(outBytes.data() + outOffsets[v], outDegrees[v]); }
+	Row inRow(int v) const { return Row(inBytes.data() + inOffsets[v], inDegrees[v]); }
+	int getOutDegree(int v) const { return outDegrees[v]; }
+	int getInDegree(int v) const { return inDegrees[v]; }
+
+	// Memory report
+	size_t bytes() const;
+	double bytesPerEdge() const;
+
+	static unsigned int decode(const unsigned char *&p)
+	{
+		unsigned char b = *p++;
+		unsigned int x = b & 0x7f;
+		for (int shift = 7; b & 0x80; shift += 7)
+		{
+			b = *p++;
+			x |= (unsigned int)(b & 0x7f) << shift;
+		}
+		return x;
+	}
+
+	private:
+	vector<unsigned char> outBytes, inBytes;
+	vector<size_t> outOffsets, inOffsets;	// where each row starts
+	vector<int> outDegrees, inDegrees;
+	vector<int> denseToVID;
+	int numArcs;
+
+	static void encode(vector<unsigned char> &bytes, unsigned int x);
+	static void encodeRow(vector<unsigned char> &bytes, const int *first, const int *last);
+	void resize(int numVertices);
+
+};
+
+#endif // COMPRESSEDGRAPH_HPP_
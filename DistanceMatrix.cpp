@@ -0,0 +1,317 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE: DistanceMatrix.cpp
+*  	DESCRIPTION: Implementation of the all pairs shortest path matrix
+*	URL: http://www.babelgraph.org/
+*/
+
+#include "DistanceMatrix.hpp"
+#include<limits>
+
+// the vector kernels are built with per-function target attributes and
+// chosen at run time, so a plain build still uses them where it can
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+  #define DISTANCEMATRIX_DISPATCH
+  #include<immintrin.h>
+#endif
+
+enum {TILE = DistanceMatrix::TILE};
+
+struct Kernels {
+	void (*relax)(float *c, const float *a, const float *b, size_t stride);
+	void (*relaxSeparate)(float *c, const float *a, const float *b, size_t stride);
+	const char *name;
+};
+static const Kernels & kernels();
+
+//------------------------------------------------------------------------------
+DistanceMatrix::DistanceMatrix()
+{
+	n = padded = 0;
+	stride = 0;
+	block = NULL;
+	data = NULL;
+}
+//------------------------------------------------------------------------------
+DistanceMatrix::~DistanceMatrix()
+{
+	clear();
+}
+//------------------------------------------------------------------------------
+bool DistanceMatrix::worthBuilding(int numVertices, long long numArcs)
+{
+	return (numVertices > 0) && (numVertices <= MAX_VERTICES)
+		&& (numArcs * DENSITY_DIVISOR >= (long long) numVertices * (numVertices - 1));
+}
+//------------------------------------------------------------------------------
+void DistanceMatrix::reset(int numVertices)
+{
+	clear();
+	n = numVertices;
+	padded = (n + TILE - 1) / TILE * TILE;
+	stride = padded;
+	if (padded == 0)
+		return;
+
+	block = new char[(size_t) padded * stride * sizeof(float) + ALIGNMENT];
+	data = (float *)(((size_t) block + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1));
+
+	// the padding rows and columns are vertices with no arcs, so they never
+	// shorten anything
+	float infinity = numeric_limits<float>::infinity();
+	for (int i = 0; i < padded; i++)
+	{
+		float *r = row(i);
+		for (int j = 0; j < padded; j++)
+			r[j] = infinity;
+		r[i] = 0;
+	}
+}
+//------------------------------------------------------------------------------
+void DistanceMatrix::clear()
+{
+	delete [] block;
+	block = NULL;
+	data = NULL;
+	n = padded = 0;
+	stride = 0;
+}
+//------------------------------------------------------------------------------
+void DistanceMatrix::floydWarshall()
+{
+	// looked up once, before the threads start
+	static const Kernels &kernel = kernels();
+
+	int tiles = padded / TILE;
+	for (int k = 0; k < tiles; k++)
+	{
+		// the diagonal tile only depends on itself
+		float *diagonal = tile(k, k);
+		kernel.relax(diagonal, diagonal, diagonal, stride);
+
+		// row k and column k only on it
+		#pragma omp parallel for schedule(dynamic)
+		for (int t = 0; t < tiles; t++)
+		{
+			if (t == k)
+				continue;
+			kernel.relax(tile(k, t), diagonal, tile(k, t), stride);
+			kernel.relax(tile(t, k), tile(t, k), diagonal, stride);
+		}
+
+		// and everything else on row k and column k
+		#pragma omp parallel for schedule(dynamic)
+		for (int t = 0; t < tiles * tiles; t++)
+		{
+			int i = t / tiles, j = t % tiles;
+			if ((i != k) && (j != k))
+				kernel.relaxSeparate(tile(i, j), tile(i, k), tile(k, j), stride);
+		}
+	}
+}
+//------------------------------------------------------------------------------
+// The tile kernels, c = min(c, a (x) b) on TILE x TILE floats that are
+// stride apart.  relaxTile() allows c to be a or b; relaxSeparateTile(),
+// for the tiles off row and column k, doesn't and is faster.  Each comes
+// as plain code the compiler can vectorize and, on x86 with GCC or Clang,
+// as AVX and AVX-512 versions compiled for those whatever the build
+// targets; kernels() picks the widest the processor has.
+//------------------------------------------------------------------------------
+static void relaxTile(float *c, const float *a, const float *b, size_t stride)
+{
+	// k has to be the outer loop when c is a or b: row k of c (or column k)
+	// is then final before anything reads it, as in the plain algorithm.
+	// An infinite a[i][k] can't shorten row i and is skipped, which is most
+	// of them early on in a sparse graph.
+	float infinity = numeric_limits<float>::infinity();
+	for (int k = 0; k < TILE; k++)
+	{
+		const float *bk = b + k * stride;
+		for (int i = 0; i < TILE; i++)
+		{
+			float aik = a[i * stride + k];
+			if (aik == infinity)
+				continue;
+
+			float *ci = c + i * stride;
+			for (int j = 0; j < TILE; j++)
+			{
+				float sum = aik + bk[j];
+				ci[j] = (sum < ci[j]) ? sum : ci[j];
+			}
+		}
+	}
+}
+//------------------------------------------------------------------------------
+static void relaxSeparateTile(float *c, const float *a, const float *b, size_t stride)
+{
+	// c is neither a nor b, so the order is free: each row of c is held in
+	// registers while all of b streams past it
+	float infinity = numeric_limits<float>::infinity();
+	for (int i = 0; i < TILE; i++)
+	{
+		const float *ai = a + i * stride;
+		float *ci = c + i * stride;
+
+		float cs[TILE];
+		for (int j = 0; j < TILE; j++)
+			cs[j] = ci[j];
+		for (int k = 0; k < TILE; k++)
+		{
+			if (ai[k] == infinity)
+				continue;
+			const float *bk = b + k * stride;
+			for (int j = 0; j < TILE; j++)
+			{
+				float sum = ai[k] + bk[j];
+				cs[j] = (sum < cs[j]) ? sum : cs[j];
+			}
+		}
+		for (int j = 0; j < TILE; j++)
+			ci[j] = cs[j];
+	}
+}
+#ifdef DISTANCEMATRIX_DISPATCH
+//------------------------------------------------------------------------------
+__attribute__((target("avx")))
+static void relaxTileAVX(float *c, const float *a, const float *b, size_t stride)
+{
+	float infinity = numeric_limits<float>::infinity();
+	for (int k = 0; k < TILE; k++)
+	{
+		const float *bk = b + k * stride;
+		for (int i = 0; i < TILE; i++)
+		{
+			float aik = a[i * stride + k];
+			if (aik == infinity)
+				continue;
+
+			float *ci = c + i * stride;
+			__m256 through = _mm256_set1_ps(aik);
+			for (int j = 0; j < TILE; j += 8)
+				_mm256_store_ps(ci + j, _mm256_min_ps(_mm256_load_ps(ci + j), _mm256_add_ps(through, _mm256_load_ps(bk + j))));
+		}
+	}
+}
+//------------------------------------------------------------------------------
+__attribute__((target("avx")))
+static void relaxSeparateTileAVX(float *c, const float *a, const float *b, size_t stride)
+{
+	float infinity = numeric_limits<float>::infinity();
+	for (int i = 0; i < TILE; i++)
+	{
+		const float *ai = a + i * stride;
+		float *ci = c + i * stride;
+
+		__m256 cs[TILE / 8];
+		for (int j = 0; j < TILE / 8; j++)
+			cs[j] = _mm256_load_ps(ci + 8 * j);
+		for (int k = 0; k < TILE; k++)
+		{
+			if (ai[k] == infinity)
+				continue;
+			const float *bk = b + k * stride;
+			__m256 through = _mm256_set1_ps(ai[k]);
+			for (int j = 0; j < TILE / 8; j++)
+				cs[j] = _mm256_min_ps(cs[j], _mm256_add_ps(through, _mm256_load_ps(bk + 8 * j)));
+		}
+		for (int j = 0; j < TILE / 8; j++)
+			_mm256_store_ps(ci + 8 * j, cs[j]);
+	}
+}
+//------------------------------------------------------------------------------
+// GCC 12 warns about the placeholder _mm512_min_ps() passes internally
+#if defined(__GNUC__) && !defined(__clang__)
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+__attribute__((target("avx512f")))
+static void relaxTileAVX512(float *c, const float *a, const float *b, size_t stride)
+{
+	float infinity = numeric_limits<float>::infinity();
+	for (int k = 0; k < TILE; k++)
+	{
+		const float *bk = b + k * stride;
+		for (int i = 0; i < TILE; i++)
+		{
+			float aik = a[i * stride + k];
+			if (aik == infinity)
+				continue;
+
+			float *ci = c + i * stride;
+			__m512 through = _mm512_set1_ps(aik);
+			for (int j = 0; j < TILE; j += 16)
+				_mm512_store_ps(ci + j, _mm512_min_ps(_mm512_load_ps(ci + j), _mm512_add_ps(through, _mm512_load_ps(bk + j))));
+		}
+	}
+}
+//------------------------------------------------------------------------------
+__attribute__((target("avx512f")))
+static void relaxSeparateTileAVX512(float *c, const float *a, const float *b, size_t stride)
+{
+	float infinity = numeric_limits<float>::infinity();
+	for (int i = 0; i < TILE; i++)
+	{
+		const float *ai = a + i * stride;
+		float *ci = c + i * stride;
+
+		__m512 c0 = _mm512_load_ps(ci), c1 = _mm512_load_ps(ci + 16);
+		__m512 c2 = _mm512_load_ps(ci + 32), c3 = _mm512_load_ps(ci + 48);
+		for (int k = 0; k < TILE; k++)
+		{
+			if (ai[k] == infinity)
+				continue;
+			const float *bk = b + k * stride;
+			__m512 through = _mm512_set1_ps(ai[k]);
+			c0 = _mm512_min_ps(c0, _mm512_add_ps(through, _mm512_load_ps(bk)));
+			c1 = _mm512_min_ps(c1, _mm512_add_ps(through, _mm512_load_ps(bk + 16)));
+			c2 = _mm512_min_ps(c2, _mm512_add_ps(through, _mm512_load_ps(bk + 32)));
+			c3 = _mm512_min_ps(c3, _mm512_add_ps(through, _mm512_load_ps(bk + 48)));
+		}
+		_mm512_store_ps(ci, c0);
+		_mm512_store_ps(ci + 16, c1);
+		_mm512_store_ps(ci + 32, c2);
+		_mm512_store_ps(ci + 48, c3);
+	}
+}
+#if defined(__GNUC__) && !defined(__clang__)
+  #pragma GCC diagnostic pop
+#endif
+#endif
+//------------------------------------------------------------------------------
+static const Kernels & kernels()
+{
+	static const Kernels plain = {relaxTile, relaxSeparateTile, "plain"};
+	#ifdef DISTANCEMATRIX_DISPATCH
+	static const Kernels avx = {relaxTileAVX, relaxSeparateTileAVX, "AVX"};
+	static const Kernels avx512 = {relaxTileAVX512, relaxSeparateTileAVX512, "AVX-512"};
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f"))
+		return avx512;
+	if (__builtin_cpu_supports("avx"))
+		return avx;
+	#endif
+	return plain;
+}
+//------------------------------------------------------------------------------
+const char * DistanceMatrix::instructionSet()
+{
+	return kernels().name;
+}
+//------------------------------------------------------------------------------
+size_t DistanceMatrix::bytes() const
+{
+	return block ? (size_t) padded * stride * sizeof(float) + ALIGNMENT : 0;
+}
@@ -0,0 +1,81 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE:  DistanceMatrix.hpp
+*  	DESCRIPTION:  Header file for an all pairs shortest path matrix
+*					for dense weighted graphs
+*	URL: http://www.babelgraph.org/
+*/
+
+#ifndef DISTANCEMATRIX_HPP_
+#define DISTANCEMATRIX_HPP_
+
+#include<cstddef>
+
+using namespace std;
+
+// A DistanceMatrix holds the n x n path lengths of a graph as floats, row
+// by row, and closes them under min-plus with a blocked Floyd-Warshall
+// (GraphSnapshot::allPairsFW() fills in the arcs).  Missing paths are
+// +infinity, which min and + carry through without any overflow checks.
+//
+// The rows are padded to a whole number of TILE x TILE tiles and the block
+// is aligned to a cache line, so each tile row is aligned for vector loads.
+// For each diagonal tile k the update runs in three rounds: tile (k,k) on
+// its own, then the rest of row k and column k (which only need tile k),
+// then every other tile, each of which reads one tile from row k and one
+// from column k.  Within a round the tiles are independent and are handed
+// out to the available cores.  The inner loop, c[j] = min(c[j], a + b[j])
+// along a tile row, uses AVX-512 or AVX when the processor has them, picked
+// at run time, and plain code the compiler can vectorize otherwise.
+//
+// At 4 bytes a pair this is for a few thousand vertices; worthBuilding()
+// says when it beats one Dijkstra per source.
+
+class DistanceMatrix {
+
+	public:
+	enum {TILE = 64, ALIGNMENT = 64};
+	enum {MAX_VERTICES = 4096, DENSITY_DIVISOR = 16};	// 64 MB at most
+
+	DistanceMatrix();
+	~DistanceMatrix();
+
+	static bool worthBuilding(int numVertices, long long numArcs);
+	void reset(int numVertices);		// every pair infinite but i --> i
+	void floydWarshall();
+	void clear();
+
+	int size() const { return n; }
+	float * row(int i) { return data + (size_t) i * stride; }
+	const float * row(int i) const { return data + (size_t) i * stride; }
+
+	size_t bytes() const;	// memory held, in bytes
+	static const char * instructionSet();	// of the tile kernels in use
+
+	private:
+	int n, padded;
+	size_t stride;
+	char *block;		// as allocated
+	float *data;		// aligned within it
+
+	float * tile(int ti, int tj) { return data + (size_t) ti * TILE * stride + (size_t) tj * TILE; }
+
+	// no copying
+	DistanceMatrix(const DistanceMatrix &);
+	DistanceMatrix & operator=(const DistanceMatrix &);
+
+};
+
+#endif // DISTANCEMATRIX_HPP_
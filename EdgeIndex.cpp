@@ -0,0 +1,151 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE: EdgeIndex.cpp
+*  	DESCRIPTION: Implementation of the (from, to) --> edge ID hash table
+*	URL: http://www.babelgraph.org/
+*/
+
+#include "EdgeIndex.hpp"
+
+//------------------------------------------------------------------------------
+EdgeIndex::EdgeIndex()
+{
+	clear();
+}
+//------------------------------------------------------------------------------
+int EdgeIndex::find(int from, int to) const
+{
+	unsigned int i = hash(from, to) & mask;
+
+	// walk the probe sequence until we hit the key or an empty slot
+	while (table[i].edgeID != EMPTY)
+	{
+		if ((table[i].edgeID != TOMBSTONE) && (table[i].from == from) && (table[i].to == to))
+			return table[i].edgeID;
+		i = (i + 1) & mask;
+	}
+
+	return -1;	// not connected
+}
+//------------------------------------------------------------------------------
+void EdgeIndex::insert(int from, int to, int edgeID)
+{
+	// keep the table at most half full, counting tombstones
+	if (2 * (count + tombstones + 1) > (int) table.size())
+		rebuild(2 * count + 2 > (int) table.size() ? 2 * table.size() : table.size());
+
+	unsigned int i = hash(from, to) & mask;
+	int reuse = -1;
+
+	while (table[i].edgeID != EMPTY)
+	{
+		if ((table[i].edgeID == TOMBSTONE) && (reuse < 0))
+			reuse = i;
+		else if ((table[i].edgeID != TOMBSTONE) && (table[i].from == from) && (table[i].to == to))
+		{
+			table[i].edgeID = edgeID;	// already there, just update the ID
+			return;
+		}
+		i = (i + 1) & mask;
+	}
+
+	if (reuse >= 0)
+	{
+		i = reuse;
+		tombstones--;
+	}
+
+	table[i].from = from;
+	table[i].to = to;
+	table[i].edgeID = edgeID;
+	count++;
+}
+//------------------------------------------------------------------------------
+void EdgeIndex::erase(int from, int to)
+{
+	unsigned int i = hash(from, to) & mask;
+
+	while (table[i].edgeID != EMPTY)
+	{
+		if ((table[i].edgeID != TOMBSTONE) && (table[i].from == from) && (table[i].to == to))
+		{
+			table[i].edgeID = TOMBSTONE;
+			count--;
+			tombstones++;
+			return;
+		}
+		i = (i + 1) & mask;
+	}
+}
+//------------------------------------------------------------------------------
+void EdgeIndex::clear()
+{
+	// back to an empty table; rebuild() would put the old entries back
+	Slot empty;
+	empty.from = empty.to = 0;
+	empty.edgeID = EMPTY;
+	table.assign(16, empty);
+	mask = 15;
+	count = 0;
+	tombstones = 0;
+}
+//------------------------------------------------------------------------------
+void EdgeIndex::reserve(int numEdges)
+{
+	unsigned int capacity = table.size();
+	while ((int) capacity < 2 * numEdges + 2)
+		capacity *= 2;
+
+	if (capacity > table.size())
+		rebuild(capacity);
+}
+//------------------------------------------------------------------------------
+int EdgeIndex::size() const
+{
+	return count;
+}
+//------------------------------------------------------------------------------
+unsigned int EdgeIndex::hash(int from, int to)
+{
+	// mix both halves of the 64 bit key (the finalizer from MurmurHash3)
+	unsigned long long key = ((unsigned long long)(unsigned int) from << 32) | (unsigned int) to;
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdULL;
+	key ^= key >> 33;
+	key *= 0xc4ceb9fe1a85ec53ULL;
+	key ^= key >> 33;
+	return (unsigned int) key;
+}
+//------------------------------------------------------------------------------
+void EdgeIndex::rebuild(unsigned int capacity)
+{
+	// capacity must be a power of two
+	vector<Slot> old;
+	old.swap(table);
+
+	Slot empty;
+	empty.from = empty.to = 0;
+	empty.edgeID = EMPTY;
+	table.assign(capacity, empty);
+	mask = capacity - 1;
+	count = 0;
+	tombstones = 0;
+
+	for (unsigned int s = 0; s < old.size(); s++)
+	{
+		if (old[s].edgeID >= 0)
+			insert(old[s].from, old[s].to, old[s].edgeID);
+	}
+}
@@ -0,0 +1,61 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE:  EdgeIndex.hpp
+*  	DESCRIPTION:  Header file for an open addressing hash table that maps
+*					(from, to) vertex pairs to edge IDs
+*	URL: http://www.babelgraph.org/
+*/
+
+#ifndef EDGEINDEX_HPP_
+#define EDGEINDEX_HPP_
+
+#include<vector>
+
+using namespace std;
+
+// EdgeIndex answers "is there an edge from A to B, and what is its ID?" in
+// constant expected time.  It uses linear probing in a power of two sized
+// table that is never more than half full; removed entries are marked with
+// a tombstone and cleaned out the next time the table is rebuilt.
+
+class EdgeIndex {
+
+	public:
+	EdgeIndex();
+
+	int find(int from, int to) const;	// returns the edge ID, or -1 if there is no such edge
+	void insert(int from, int to, int edgeID);
+	void erase(int from, int to);
+	void clear();
+	void reserve(int numEdges);
+	int size() const;
+
+	private:
+	enum {EMPTY = -1, TOMBSTONE = -2};
+
+	struct Slot {
+		int from, to, edgeID;
+	};
+
+	vector<Slot> table;
+	unsigned int mask;
+	int count, tombstones;
+
+	static unsigned int hash(int from, int to);
+	void rebuild(unsigned int capacity);
+
+};
+
+#endif // EDGEINDEX_HPP_
@@ -0,0 +1,175 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE: GraphJournal.cpp
+*  	DESCRIPTION: Implementation of the change journal
+*	URL: http://www.babelgraph.org/
+*/
+
+#include "GraphJournal.hpp"
+
+unsigned long GraphJournal::lastSequence = 0;
+
+//------------------------------------------------------------------------------
+GraphChange::GraphChange(int k, int changed)
+{
+	kind = k;
+	sequence = 0;
+	id = changed;
+	from = to = -1;
+	weight = 1.0;
+	x = y = z = 0;
+	color = oldColor = 0;
+}
+//------------------------------------------------------------------------------
+GraphJournal::GraphJournal()
+{
+	depth = 0;
+	mode = EDITING;
+	reset();
+}
+//------------------------------------------------------------------------------
+void GraphJournal::beginEdit()
+{
+	depth++;
+}
+//------------------------------------------------------------------------------
+void GraphJournal::endEdit()
+{
+	if (--depth > 0)
+		return;
+
+	depth = 0;
+	if (step.empty() && !stepTooBig)
+		return;
+
+	// undoing builds a redo step, everything else an undo step
+	deque<vector<GraphChange> > &stack = (mode == UNDOING) ? redoSteps : undoSteps;
+	if (mode == EDITING)
+		redoSteps.clear();
+
+	if (stepTooBig)
+	{
+		// too big to keep, and the steps below it can't be undone without it
+		stack.clear();
+		if (mode != UNDOING)
+			undoSize = 0;
+	}
+	else
+	{
+		if (mode != UNDOING)
+			undoSize += step.size();
+		stack.push_back(vector<GraphChange>());
+		stack.back().swap(step);
+	}
+
+	while ((undoSteps.size() > UNDO_STEPS) || (undoSize > UNDO_LIMIT))
+	{
+		undoSize -= undoSteps.front().size();
+		undoSteps.pop_front();
+	}
+
+	step.clear();
+	stepTooBig = false;
+}
+//------------------------------------------------------------------------------
+void GraphJournal::record(GraphChange &change)
+{
+	change.sequence = head = ++lastSequence;
+
+	log.push_back(change);
+	if (log.size() > LOG_LIMIT)
+	{
+		base = log.front().sequence;
+		log.pop_front();
+	}
+
+	// a change made outside any edit is a step of its own
+	bool alone = (depth == 0);
+	if (alone)
+		beginEdit();
+
+	if (!stepTooBig)
+	{
+		if (step.size() < UNDO_LIMIT)
+			step.push_back(change);
+		else
+		{
+			stepTooBig = true;
+			vector<GraphChange>().swap(step);
+		}
+	}
+
+	if (alone)
+		endEdit();
+}
+//------------------------------------------------------------------------------
+void GraphJournal::reset()
+{
+	log.clear();
+	base = head = ++lastSequence;
+	undoSteps.clear();
+	redoSteps.clear();
+	undoSize = 0;
+	step.clear();
+	stepTooBig = false;
+}
+//------------------------------------------------------------------------------
+bool GraphJournal::takeStep(MODE replay, vector<GraphChange> &taken)
+{
+	deque<vector<GraphChange> > &stack = (replay == UNDOING) ? undoSteps : redoSteps;
+	if (stack.empty())
+		return false;
+
+	taken.swap(stack.back());
+	stack.pop_back();
+	if (replay == UNDOING)
+		undoSize -= taken.size();
+	return true;
+}
+//------------------------------------------------------------------------------
+void GraphJournal::setMode(MODE newMode)
+{
+	mode = newMode;
+}
+//------------------------------------------------------------------------------
+unsigned long GraphJournal::getHead() const
+{
+	return head;
+}
+//------------------------------------------------------------------------------
+bool GraphJournal::getChangesSince(unsigned long cursor, vector<GraphChange> &changes) const
+{
+	changes.clear();
+	if ((cursor < base) || (cursor > head))
+		return false;	// too old, or not from this graph
+
+	// sequence numbers in the log are increasing but not consecutive, since
+	// other graphs draw from the same counter
+	deque<GraphChange>::const_iterator c = log.end();
+	while ((c != log.begin()) && ((c - 1)->sequence > cursor))
+		c--;
+	changes.assign(c, log.end());
+	return true;
+}
+//------------------------------------------------------------------------------
+bool GraphJournal::canUndo() const
+{
+	return !undoSteps.empty();
+}
+//------------------------------------------------------------------------------
+bool GraphJournal::canRedo() const
+{
+	return !redoSteps.empty();
+}
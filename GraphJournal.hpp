@@ -0,0 +1,112 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE:  GraphJournal.hpp
+*  	DESCRIPTION:  Header file for the record of changes made to a NiceGraph,
+*					used for incremental updates and undo/redo
+*	URL: http://www.babelgraph.org/
+*/
+
+#ifndef GRAPHJOURNAL_HPP_
+#define GRAPHJOURNAL_HPP_
+
+#include<string>
+#include<vector>
+#include<deque>
+
+using namespace std;
+
+// One change to a graph.  Each kind only uses some of the fields; a
+// removal carries everything needed to put the vertex or edge back.
+struct GraphChange {
+	enum KIND {VERTEX_ADDED=0, VERTEX_REMOVED, EDGE_ADDED, EDGE_REMOVED, NAME_CHANGED, COLOR_CHANGED,
+		VERTEX_ATTRIBUTE_CHANGED, EDGE_ATTRIBUTE_CHANGED, MADE_UNDIRECTED, MADE_DIRECTED};
+
+	int kind;
+	unsigned long sequence;	// stamped by the journal
+	int id;					// the vertex or edge
+	int from, to;			// edges
+	float weight;			// edges
+	float x, y, z;			// removed vertices
+	int color, oldColor;	// color changes, removed vertices
+	string column;			// attribute changes, by name, since removing a column moves the ones after it
+	string text, oldText;	// names and attribute values as text
+	vector<string> row;		// every attribute of a removed vertex or edge, as text
+	vector<string> columns;	// and the names of their columns
+
+	GraphChange(int k = VERTEX_ADDED, int changed = -1);
+};
+
+// A GraphJournal keeps two things for its NiceGraph.
+//
+// A log of recent changes, each stamped with a sequence number.  Anyone who
+// keeps a copy of something derived from the graph (an index list, a combo
+// box) remembers the last number they saw and asks getChangesSince() for
+// what happened after it.  If that returns false the log doesn't reach back
+// far enough, or the cursor belongs to another graph (numbers are never
+// reused), and the copy must be rebuilt from scratch.
+//
+// And the undo and redo stacks.  NiceGraph brackets each public edit with
+// beginEdit() and endEdit(); everything recorded inside the outermost pair
+// is one step.  NiceGraph::undo() takes a step off the undo stack and
+// applies the inverse of each change in reverse order.  Those inverse
+// changes are recorded like any others, but the step they make goes onto
+// the redo stack, so redo is just the undo of an undo.
+//
+// Steps are dropped from the bottom of the undo stack to keep it under
+// UNDO_LIMIT changes; a single step bigger than that (eg. generating a
+// large graph) can't be undone and empties the stack instead.
+
+class GraphJournal {
+
+	public:
+	GraphJournal();
+
+	enum {LOG_LIMIT = 65536, UNDO_LIMIT = 262144, UNDO_STEPS = 100};
+
+	// Recording, used by NiceGraph
+	void beginEdit();
+	void endEdit();
+	void record(GraphChange &change);
+	void reset();				// forget everything, eg. after loading a file
+
+	// Replaying a step for undo/redo
+	enum MODE {EDITING = 0, UNDOING, REDOING};
+	bool takeStep(MODE mode, vector<GraphChange> &step);	// false if the stack is empty
+	void setMode(MODE mode);
+
+	// The cursor API
+	unsigned long getHead() const;	// sequence number of the latest change
+	bool getChangesSince(unsigned long cursor, vector<GraphChange> &changes) const;
+
+	bool canUndo() const;
+	bool canRedo() const;
+
+	private:
+	deque<GraphChange> log;
+	unsigned long base;			// the log holds the changes after this one
+	unsigned long head;
+
+	deque<vector<GraphChange> > undoSteps, redoSteps;
+	size_t undoSize;			// changes held on the undo stack
+	vector<GraphChange> step;	// the one being recorded
+	bool stepTooBig;
+	int depth;
+	MODE mode;
+
+	static unsigned long lastSequence;	// shared by all journals
+
+};
+
+#endif // GRAPHJOURNAL_HPP_
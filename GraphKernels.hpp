@@ -0,0 +1,208 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE:  GraphKernels.hpp
+*  	DESCRIPTION:  Analyses written once for any read-only graph layout
+*					(GraphSnapshot, CompressedGraph, MappedGraph)
+*	URL: http://www.babelgraph.org/
+*/
+
+#ifndef GRAPHKERNELS_HPP_
+#define GRAPHKERNELS_HPP_
+
+#include<vector>
+#include<queue>
+#include<cmath>
+
+using namespace std;
+
+// Each kernel takes any Graph type that provides
+//	int getNumVertices() const;
+//	int getOutDegree(int v) const;
+//	Row outRow(int v) const;  Row inRow(int v) const;
+// where a Row has begin() and end() forward iterators over its neighbors
+// in increasing (dense) order.  All indices are dense.
+
+namespace GraphKernels {
+
+// the same graph with every arc turned around, so a kernel that follows
+// out rows follows in rows instead (eg. bfsDistances() gives the distances
+// *to* the source); the graph must also have getInDegree()
+template <class Graph>
+class Reversed {
+	public:
+	typedef typename Graph::Row Row;
+	Reversed(const Graph &graph) : g(graph) {}
+	int getNumVertices() const { return g.getNumVertices(); }
+	int getOutDegree(int v) const { return g.getInDegree(v); }
+	int getInDegree(int v) const { return g.getOutDegree(v); }
+	Row outRow(int v) const { return g.inRow(v); }
+	Row inRow(int v) const { return g.outRow(v); }
+
+	private:
+	const Graph &g;
+};
+
+// PageRank by power iteration, each vertex pulling along its in row from
+// the previous iteration's ranks, so vertices are independent and shared
+// out over the cores.  Ranks sum to 1.  A vertex with no out arcs passes
+// its rank to everyone, as if it linked to all of them; the rest pass
+// theirs split evenly over their out arcs, through a precomputed inverse
+// degree.  Stops after maxIterations, or sooner once an iteration changes
+// the ranks by less than tolerance in total (the L1 norm).  Returns the
+// iterations run; residual is the change in the last one.
+template <class Graph>
+int pageRank(const Graph &g, vector<float> &rank, float damping, double tolerance, int maxIterations, double &residual)
+{
+	int size = g.getNumVertices();
+	rank.assign(size, (size > 0) ? 1.0f / size : 0);
+	residual = 0;
+	if (size == 0)
+		return 0;
+
+	vector<float> inverseDegree (size), share (size), next (size);
+	for (int v = 0; v < size; v++)
+	{
+		int degree = g.getOutDegree(v);
+		inverseDegree[v] = (degree > 0) ? 1.0f / degree : 0;
+	}
+
+	int iteration = 0;
+	while (iteration < maxIterations)
+	{
+		// what each vertex passes along each of its arcs, and what the
+		// dangling ones hold between them
+		double dangling = 0;
+		#pragma omp parallel for reduction(+:dangling)
+		for (int v = 0; v < size; v++)
+		{
+			share[v] = rank[v] * inverseDegree[v];
+			if (inverseDegree[v] == 0)
+				dangling += rank[v];
+		}
+
+		float base = (float)((1.0 - damping + damping * dangling) / size);
+		double change = 0;
+		#pragma omp parallel for reduction(+:change) schedule(dynamic, 1024)
+		for (int v = 0; v < size; v++)
+		{
+			float votes = 0;
+			typename Graph::Row in = g.inRow(v);
+			for (typename Graph::Row::const_iterator n = in.begin(); n != in.end(); ++n)
+				votes += share[*n];
+
+			next[v] = base + damping * votes;
+			change += fabs((double) next[v] - rank[v]);
+		}
+
+		rank.swap(next);
+		residual = change;
+		iteration++;
+		if (residual < tolerance)
+			break;
+	}
+	return iteration;
+}
+
+// hop counts from source along the out rows, -1 where it can't reach
+template <class Graph>
+void bfsDistances(const Graph &g, int source, vector<int> &distance)
+{
+	distance.assign(g.getNumVertices(), -1);
+	distance[source] = 0;
+
+	queue<int> Q;
+	Q.push(source);
+	while (!Q.empty())
+	{
+		int v = Q.front();
+		Q.pop();
+
+		typename Graph::Row out = g.outRow(v);
+		for (typename Graph::Row::const_iterator n = out.begin(); n != out.end(); ++n)
+		{
+			if (distance[*n] < 0)
+			{
+				distance[*n] = distance[v] + 1;
+				Q.push(*n);
+			}
+		}
+	}
+}
+
+// smallest, largest and mean out-degree; touches only the row offsets
+template <class Graph>
+void degreeStats(const Graph &g, int &minDegree, int &maxDegree, double &meanDegree)
+{
+	int size = g.getNumVertices();
+	long long total = 0;
+	minDegree = maxDegree = 0;
+
+	for (int v = 0; v < size; v++)
+	{
+		int d = g.getOutDegree(v);
+		if ((v == 0) || (d < minDegree))
+			minDegree = d;
+		if (d > maxDegree)
+			maxDegree = d;
+		total += d;
+	}
+
+	meanDegree = (size > 0) ? (double) total / size : 0;
+}
+
+// Number of triangles, reading each out row as a neighbor set.  Meant for
+// undirected graphs, whose snapshots list every edge in the rows of both
+// ends.  Each triangle v < u < w is found once, from v, by merging the part
+// of v's row above u with u's row.
+template <class Graph>
+long long countTriangles(const Graph &g)
+{
+	long long triangles = 0;
+	int size = g.getNumVertices();
+
+	for (int v = 0; v < size; v++)
+	{
+		typename Graph::Row vRow = g.outRow(v);
+		for (typename Graph::Row::const_iterator u = vRow.begin(); u != vRow.end(); ++u)
+		{
+			if (*u <= v)
+				continue;
+
+			typename Graph::Row::const_iterator a = u;
+			++a;
+			typename Graph::Row uRow = g.outRow(*u);
+			typename Graph::Row::const_iterator b = uRow.begin();
+
+			while ((a != vRow.end()) && (b != uRow.end()))
+			{
+				if (*a < *b)
+					++a;
+				else if (*b < *a)
+					++b;
+				else
+				{
+					triangles++;
+					++a; ++b;
+				}
+			}
+		}
+	}
+
+	return triangles;
+}
+
+}
+
+#endif // GRAPHKERNELS_HPP_
@@ -0,0 +1,855 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE: GraphSnapshot.cpp
+*  	DESCRIPTION: Implementation of the compressed sparse row graph snapshot
+*					and the analyses that run on it
+*	URL: http://www.babelgraph.org/
+*/
+
+#include "GraphSnapshot.hpp"
+#include "GraphKernels.hpp"
+#include<iterator>
+#include<queue>
+#include<cmath>
+#include<functional>
+
+namespace {
+
+// orders dense indices by a key per vertex
+struct LessDegree {
+	const vector<int> &key;
+	LessDegree(const vector<int> &k) : key(k) {}
+	bool operator()(int a, int b) const { return key[a] < key[b]; }
+};
+
+}
+
+//------------------------------------------------------------------------------
+GraphSnapshot::GraphSnapshot()
+{
+	version = 0;
+	outOffsets.push_back(0);
+	inOffsets.push_back(0);
+}
+//------------------------------------------------------------------------------
+int GraphSnapshot::getNumVertices() const
+{
+	return denseToVID.size();
+}
+//------------------------------------------------------------------------------
+int GraphSnapshot::getNumEdges() const
+{
+	return outNeighbors.size();
+}
+//------------------------------------------------------------------------------
+unsigned long GraphSnapshot::getVersion() const
+{
+	return version;
+}
+//------------------------------------------------------------------------------
+int GraphSnapshot::getVID(int denseIndex) const
+{
+	return denseToVID[denseIndex];
+}
+//------------------------------------------------------------------------------
+int GraphSnapshot::getDenseIndex(int vertexID) const
+{
+	if ((vertexID < 0) || (vertexID >= (int) vidToDense.size()))
+		return -1;
+
+	return vidToDense[vertexID];
+}
+//------------------------------------------------------------------------------
+unsigned int GraphSnapshot::getGeneration(int denseIndex) const
+{
+	return denseGeneration[denseIndex];
+}
+//------------------------------------------------------------------------------
+size_t GraphSnapshot::bytes() const
+{
+	return (outOffsets.capacity() + outNeighbors.capacity() + inOffsets.capacity() + inNeighbors.capacity()
+		+ denseToVID.capacity() + vidToDense.capacity() + denseGeneration.capacity()) * sizeof(int)
+		+ outWeight.capacity() * sizeof(float) + bits.bytes() + packed.bytes();
+}
+//------------------------------------------------------------------------------
+const BitMatrix * GraphSnapshot::getBitMatrix() const
+{
+	return bits.empty() ? NULL : &bits;
+}
+//------------------------------------------------------------------------------
+const CompressedGraph * GraphSnapshot::getCompressedGraph() const
+{
+	return packed.empty() ? NULL : &packed;
+}
+//------------------------------------------------------------------------------
+bool GraphSnapshot::testFromToConnected(int from, int to) const
+{
+	// rows are sorted, so a binary search will do
+	return binary_search(outBegin(from), outEnd(from), to);
+}
+//------------------------------------------------------------------------------
+PageRankReport GraphSnapshot::pageRank(vector<float> &rank, float damping, double tolerance, int maxIterations) const
+{
+	PageRankReport report;
+	if (!packed.empty())
+		report.iterations = GraphKernels::pageRank(packed, rank, damping, tolerance, maxIterations, report.residual);
+	else
+		report.iterations = GraphKernels::pageRank(*this, rank, damping, tolerance, maxIterations, report.residual);
+	report.converged = (report.residual < tolerance);
+	return report;
+}
+//------------------------------------------------------------------------------
+void GraphSnapshot::allPairsFW(DistanceMatrix &distance) const
+{
+	// the arcs, keeping the lightest where there are several, then the
+	// blocked Floyd-Warshall does the rest
+	int size = getNumVertices();
+	distance.reset(size);
+	for (int q = 0; q < size; q++)
+	{
+		float *row = distance.row(q);
+		const float *w = outWeights(q);
+		for (const int *r = outBegin(q); r != outEnd(q); r++, w++)
+			if (*w < row[*r])
+				row[*r] = *w;
+	}
+
+	distance.floydWarshall();
+}
+//------------------------------------------------------------------------------
+bool GraphSnapshot::pathMetrics(PathMetrics &metrics) const
+{
+	int size = getNumVertices();
+	metrics.sums.assign(size, 0);
+	metrics.reached.assign(size, 0);
+	metrics.eccentricity.assign(size, 0);
+	metrics.histogram.clear();
+	bool unit = hasUnitWeights();
+
+	// neither Dijkstra nor Floyd-Warshall gets shortest paths right with a
+	// negative weight, so then none are reached
+	if (!unit && hasNegativeWeights())
+	{
+		averagePathMetrics(metrics);
+		return false;
+	}
+
+	// on a dense weighted graph one blocked Floyd-Warshall is much faster than
+	// a Dijkstra per source, and its rows are folded in just the same
+	DistanceMatrix matrix;
+	bool dense = !unit && DistanceMatrix::worthBuilding(size, getNumEdges());
+	if (dense)
+		allPairsFW(matrix);
+
+	// each thread keeps one row of distances and its own histogram, reused
+	// for every source it is handed; sources finish at very different
+	// speeds, hence dynamic
+	#pragma omp parallel
+	{
+		vector<int> hops;
+		vector<double> distance;
+		vector<long long> histogram;
+
+		#pragma omp for schedule(dynamic, 16)
+		for (int s = 0; s < size; s++)
+		{
+			if (unit)
+			{
+				bfsDistances(s, hops);
+				distance.assign(hops.begin(), hops.end());
+			}
+			else if (dense)
+				distance.assign(matrix.row(s), matrix.row(s) + size);	// +inf becomes HUGE_VAL
+			else
+				dijkstraDistances(s, distance);
+
+			double sum = 0, farthest = 0;
+			int count = 0;
+			for (int v = 0; v < size; v++)
+			{
+				double d = distance[v];
+				if ((d < 0) || (d == HUGE_VAL))
+					continue;	// not reachable
+
+				sum += d;
+				count++;
+				if (d > farthest)
+					farthest = d;
+				if (unit && (v != s))
+				{
+					unsigned int bin = (unsigned int) d;
+					if (bin >= histogram.size())
+						histogram.resize(bin + 1, 0);
+					histogram[bin]++;
+				}
+			}
+			metrics.sums[s] = sum;
+			metrics.reached[s] = count;
+			metrics.eccentricity[s] = farthest;
+		}
+
+		#pragma omp critical
+		{
+			if (histogram.size() > metrics.histogram.size())
+				metrics.histogram.resize(histogram.size(), 0);
+			for (unsigned int b = 0; b < histogram.size(); b++)
+				metrics.histogram[b] += histogram[b];
+		}
+	}
+
+	averagePathMetrics(metrics);
+	return true;
+}
+//------------------------------------------------------------------------------
+void GraphSnapshot::averagePathMetrics(PathMetrics &metrics)
+{
+	int size = metrics.sums.size();
+
+	// avgPath counts everything unreachable as a failure, closeness only
+	// averages over what is reachable, so it always returns a normal value
+	// even if the graph is partially disconnected
+	metrics.avgPath.resize(size);
+	metrics.closeness.resize(size);
+	long double total = 0;
+	bool connected = true;
+	metrics.diameter = 0;
+	for (int m = 0; m < size; m++)
+	{
+		if (metrics.reached[m] < size)
+		{
+			metrics.avgPath[m] = -1;
+			connected = false;
+		}
+		else
+			metrics.avgPath[m] = (long double) metrics.sums[m] / (size - 1);
+
+		if (metrics.reached[m] > 1)
+			metrics.closeness[m] = (long double) metrics.sums[m] / (metrics.reached[m] - 1);
+		else
+			metrics.closeness[m] = 0;	// can only get to itself
+
+		total += metrics.sums[m];
+		if (metrics.eccentricity[m] > metrics.diameter)
+			metrics.diameter = metrics.eccentricity[m];
+	}
+	metrics.graphAvgPath = connected ? (float)(total / ((long double) size * (size - 1))) : -1;
+}
+//------------------------------------------------------------------------------
+void GraphSnapshot::estimatePathMetrics(PathEstimate &estimate, int pivots, float targetError, unsigned int seed) const
+{
+	int size = getNumVertices();
+	int limit = (pivots > 0) ? min(pivots, size) : size;
+	bool unit = hasUnitWeights();
+
+	// per vertex: the distances to the pivots it reaches, summed and squared
+	vector<double> sums (size, 0), squares (size, 0);
+	vector<int> counts (size, 0);
+	// per pivot: the mean distance into it from everyone else
+	double pivotSum = 0, pivotSquares = 0;
+	bool connected = true;
+
+	// the pivots are the front of a shuffle, drawn a round at a time from
+	// a generator of our own so the result only depends on the seed
+	vector<int> order (size);
+	for (int v = 0; v < size; v++)
+		order[v] = v;
+	unsigned long long state = seed;
+
+	vector<vector<float> > rows (ESTIMATE_ROUND);
+	vector<double> rowMeans (ESTIMATE_ROUND);
+	vector<char> rowReachesAll (ESTIMATE_ROUND);
+
+	int done = 0;
+	estimate.closeness.assign(size, 0);
+	estimate.closenessError.assign(size, -1);
+	while (done < limit)
+	{
+		int round = min((int) ESTIMATE_ROUND, limit - done);
+		for (int r = 0; r < round; r++)
+		{
+			state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+			int pick = done + r + (int)((state >> 33) % (unsigned long long)(size - done - r));
+			swap(order[done + r], order[pick]);
+		}
+
+		// the searches, one per thread at a time
+		#pragma omp parallel
+		{
+			vector<int> hops;
+			vector<double> distance;
+
+			#pragma omp for schedule(dynamic, 1)
+			for (int r = 0; r < round; r++)
+			{
+				int p = order[done + r];
+				vector<float> &row = rows[r];
+				row.resize(size);
+				if (unit)
+				{
+					GraphKernels::bfsDistances(GraphKernels::Reversed<GraphSnapshot>(*this), p, hops);
+					for (int v = 0; v < size; v++)
+						row[v] = (hops[v] < 0) ? -1 : hops[v];
+				}
+				else
+				{
+					dijkstraDistances(p, distance, true);
+					for (int v = 0; v < size; v++)
+						row[v] = (distance[v] == HUGE_VAL) ? -1 : distance[v];
+				}
+
+				double sum = 0;
+				int count = 0;
+				for (int v = 0; v < size; v++)
+				{
+					if (row[v] >= 0)
+					{
+						sum += row[v];
+						count++;
+					}
+				}
+				rowReachesAll[r] = (count == size);
+				rowMeans[r] = (size > 1) ? sum / (size - 1) : 0;
+			}
+		}
+
+		// folded in by vertex, so no two threads write the same totals
+		#pragma omp parallel for
+		for (int v = 0; v < size; v++)
+		{
+			for (int r = 0; r < round; r++)
+			{
+				float d = rows[r][v];
+				if ((d >= 0) && (order[done + r] != v))		// reachable, and not v itself
+				{
+					sums[v] += d;
+					squares[v] += (double) d * d;
+					counts[v]++;
+				}
+			}
+		}
+
+		for (int r = 0; r < round; r++)
+		{
+			connected = connected && rowReachesAll[r];
+			pivotSum += rowMeans[r];
+			pivotSquares += rowMeans[r] * rowMeans[r];
+		}
+		done += round;
+
+		// the intervals so far: 1.96 standard errors, shrunk by the finite
+		// population correction so they close up as the sample nears
+		// everyone
+		float shrink = sqrt(max(0.0, 1.0 - (double) done / size));
+		double relative = 0;
+		int measured = 0;
+		for (int v = 0; v < size; v++)
+		{
+			int k = counts[v];
+			if (k == 0)
+				continue;
+
+			double mean = sums[v] / k;
+			estimate.closeness[v] = mean;
+			if (k > 1)
+			{
+				double variance = max(0.0, (squares[v] - k * mean * mean) / (k - 1));
+				estimate.closenessError[v] = 1.96 * sqrt(variance / k) * shrink;
+				if (mean > 0)
+				{
+					relative += estimate.closenessError[v] / mean;
+					measured++;
+				}
+			}
+		}
+
+		double mean = pivotSum / done;
+		double variance = (done > 1) ? max(0.0, (pivotSquares - done * mean * mean) / (done - 1)) : 0;
+		estimate.graphAvgPath = connected ? mean : -1;
+		estimate.graphAvgPathError = (!connected) ? 0 : (done > 1) ? 1.96 * sqrt(variance / done) * shrink : -1;
+
+		if ((pivots > 0) || (done < 2 * ESTIMATE_ROUND))
+			continue;	// a fixed sample, or too few to judge yet
+		bool pathDone = !connected || (estimate.graphAvgPathError <= targetError * mean);
+		bool closenessDone = (measured == 0) || (relative / measured <= targetError);
+		if (pathDone && closenessDone)
+			break;
+	}
+	estimate.pivots = done;
+}
+//------------------------------------------------------------------------------
+bool GraphSnapshot::hasUnitWeights() const
+{
+	for (unsigned int a = 0; a < outWeight.size(); a++)
+	{
+		if (outWeight[a] != 1.0f)
+			return false;
+	}
+	return true;
+}
+//------------------------------------------------------------------------------
+bool GraphSnapshot::hasNegativeWeights() const
+{
+	for (unsigned int a = 0; a < outWeight.size(); a++)
+	{
+		if (outWeight[a] < 0)
+			return true;
+	}
+	return false;
+}
+//------------------------------------------------------------------------------
+void GraphSnapshot::dijkstraDistances(int source, vector<double> &distance, bool towards) const
+{
+	// binary heap with stale entries skipped as they come off, cheaper than
+	// decreasing keys in place
+	if (towards)
+	{
+		reverseDijkstraDistances(source, distance);
+		return;
+	}
+
+	int size = getNumVertices();
+	distance.assign(size, HUGE_VAL);
+	distance[source] = 0;
+
+	priority_queue<pair<double,int>, vector<pair<double,int> >, greater<pair<double,int> > > Q;
+	Q.push(make_pair(0.0, source));
+	while (!Q.empty())
+	{
+		double d = Q.top().first;
+		int v = Q.top().second;
+		Q.pop();
+		if (d > distance[v])
+			continue;
+
+		const float *w = outWeights(v);
+		for (const int *u = outBegin(v); u != outEnd(v); u++, w++)
+		{
+			double through = d + *w;
+			if (through < distance[*u])
+			{
+				distance[*u] = through;
+				Q.push(make_pair(through, *u));
+			}
+		}
+	}
+}
+//------------------------------------------------------------------------------
+void GraphSnapshot::reverseDijkstraDistances(int target, vector<double> &distance) const
+{
+	// the same along the in rows; they carry no weights, so each arc's
+	// weight is looked up in the (sorted) out row it came from
+	int size = getNumVertices();
+	distance.assign(size, HUGE_VAL);
+	distance[target] = 0;
+
+	priority_queue<pair<double,int>, vector<pair<double,int> >, greater<pair<double,int> > > Q;
+	Q.push(make_pair(0.0, target));
+	while (!Q.empty())
+	{
+		double d = Q.top().first;
+		int v = Q.top().second;
+		Q.pop();
+		if (d > distance[v])
+			continue;
+
+		for (const int *u = inBegin(v); u != inEnd(v); u++)
+		{
+			const int *arc = lower_bound(outBegin(*u), outEnd(*u), v);
+			double through = d + outWeights(*u)[arc - outBegin(*u)];
+			if (through < distance[*u])
+			{
+				distance[*u] = through;
+				Q.push(make_pair(through, *u));
+			}
+		}
+	}
+}
+//------------------------------------------------------------------------------
+void GraphSnapshot::clusteringMetrics(ClusteringMetrics &metrics) const
+{
+	int size = getNumVertices();
+
+	// first every vertex's neighborhood, merged from its in and out rows,
+	// with the number of arcs (1 or 2) joining it to each neighbor
+	vector<int> start (size + 1, 0);
+	for (int v = 0; v < size; v++)
+		start[v + 1] = start[v] + getInDegree(v) + getOutDegree(v);
+	vector<int> upper (start[size]);
+	vector<unsigned char> arcs (start[size]);
+	vector<int> &degree = metrics.neighbors;
+	degree.assign(size, 0);
+
+	#pragma omp parallel for schedule(dynamic, 256)
+	for (int v = 0; v < size; v++)
+	{
+		const int *o = outBegin(v), *oEnd = outEnd(v), *i = inBegin(v), *iEnd = inEnd(v);
+		int at = start[v];
+		while ((o != oEnd) || (i != iEnd))
+		{
+			int u;
+			unsigned char n = 1;
+			if ((i == iEnd) || ((o != oEnd) && (*o < *i)))
+				u = *o++;
+			else if ((o == oEnd) || (*i < *o))
+				u = *i++;
+			else
+			{
+				u = *o++;
+				i++;
+				n = 2;
+			}
+			upper[at] = u;
+			arcs[at] = n;
+			at++;
+		}
+		degree[v] = at - start[v];
+	}
+
+	// then each keeps only the neighbors ranked above it: higher degree, or
+	// the same degree and a higher index
+	vector<int> kept (size);
+	#pragma omp parallel for schedule(dynamic, 256)
+	for (int v = 0; v < size; v++)
+	{
+		int at = start[v];
+		for (int e = start[v]; e < start[v] + degree[v]; e++)
+		{
+			int u = upper[e];
+			if ((degree[u] > degree[v]) || ((degree[u] == degree[v]) && (u > v)))
+			{
+				upper[at] = u;
+				arcs[at] = arcs[e];
+				at++;
+			}
+		}
+		kept[v] = at - start[v];
+	}
+
+	// Triangle v u w, ranked in that order, is found from v: its kept
+	// neighbors are marked with their arcs, and w is one of the marked
+	// vertices in u's kept row.  Each corner is credited with the arcs on
+	// the far side, which add up to the links among its neighbors.  Corners
+	// other than v may be another thread's v, hence the atomics.
+	vector<long long> &triangles = metrics.triangles;
+	triangles.assign(size, 0);
+	vector<long long> links (size, 0);
+	long long total = 0;
+
+	#pragma omp parallel reduction(+:total)
+	{
+		vector<unsigned char> mark (size, 0);
+
+		#pragma omp for schedule(dynamic, 64)
+		for (int v = 0; v < size; v++)
+		{
+			int vEnd = start[v] + kept[v];
+			for (int e = start[v]; e < vEnd; e++)
+				mark[upper[e]] = arcs[e];
+
+			long long found = 0, foundLinks = 0;
+			for (int e = start[v]; e < vEnd; e++)
+			{
+				int u = upper[e];
+				for (int f = start[u]; f < start[u] + kept[u]; f++)
+				{
+					int w = upper[f];
+					if (!mark[w])
+						continue;
+
+					found++;
+					foundLinks += arcs[f];
+					#pragma omp atomic
+					triangles[u]++;
+					#pragma omp atomic
+					links[u] += mark[w];
+					#pragma omp atomic
+					triangles[w]++;
+					#pragma omp atomic
+					links[w] += arcs[e];
+				}
+			}
+
+			#pragma omp atomic
+			triangles[v] += found;
+			#pragma omp atomic
+			links[v] += foundLinks;
+			total += found;
+
+			for (int e = start[v]; e < vEnd; e++)
+				mark[upper[e]] = 0;
+		}
+	}
+
+	// links over the k (k-1) ordered pairs of neighbors, as in
+	// clusteringCoefficient(); transitivity counts each triangle from all
+	// three corners against every path of length 2
+	metrics.local.resize(size);
+	double sum = 0, paths = 0;
+	for (int v = 0; v < size; v++)
+	{
+		long long max = (long long) degree[v] * (degree[v] - 1);
+		metrics.local[v] = (max > 0) ? (float) links[v] / (float) max : 0;
+		sum += metrics.local[v];
+		paths += max / 2;
+	}
+	metrics.totalTriangles = total;
+	metrics.transitivity = (paths > 0) ? 3 * total / paths : 0;
+	metrics.averageClustering = (size > 0) ? sum / size : 0;
+}
+//------------------------------------------------------------------------------
+float GraphSnapshot::clusteringCoefficient(int v) const
+{
+	if (!bits.empty())
+		return bits.clusteringCoefficient(v);
+
+	// the neighborhood is the union of the in and out neighbors, since both
+	// rows are sorted a merge gives a sorted neighborhood without duplicates
+	vector<int> ns;
+	ns.reserve(getInDegree(v) + getOutDegree(v));
+	set_union(inBegin(v), inEnd(v), outBegin(v), outEnd(v), back_inserter(ns));
+
+	int size = ns.size();
+
+	int max = size * (size - 1) ;
+
+	if (max < 1)
+		return 0;
+
+	// count the directed connections among the neighbors
+	int cnxs = 0;
+
+	for (int i = 0; i < size; i++)
+	{
+		int from = ns[i];
+		const int *a = outBegin(from), *aEnd = outEnd(from);
+		vector<int>::const_iterator b = ns.begin();
+
+		while ((a != aEnd) && (b != ns.end()))
+		{
+			if (*a < *b)
+				a++;
+			else if (*b < *a)
+				b++;
+			else
+			{
+				if (*a != from) cnxs++;	// don't connect to self
+				a++; b++;
+			}
+		}
+	}
+
+	return (float)cnxs / (float)max;
+}
+//------------------------------------------------------------------------------
+long long GraphSnapshot::countTriangles() const
+{
+	if (!bits.empty())
+		return bits.countTriangles();
+	if (!packed.empty())
+		return GraphKernels::countTriangles(packed);
+	return GraphKernels::countTriangles(*this);
+}
+//------------------------------------------------------------------------------
+void GraphSnapshot::bfsDistances(int source, vector<int> &distance) const
+{
+	if (!bits.empty())
+		bits.bfsDistances(source, distance);
+	else if (!packed.empty())
+		GraphKernels::bfsDistances(packed, source, distance);
+	else
+		GraphKernels::bfsDistances(*this, source, distance);
+}
+//------------------------------------------------------------------------------
+void GraphSnapshot::rcmOrder(vector<int> &order) const
+{
+	// Cuthill-McKee on the undirected view of the graph: breadth first from
+	// a vertex of smallest degree in each component, visiting the neighbors
+	// of each vertex in increasing degree order.  Reversing the result keeps
+	// the bandwidth the same but tends to cut the fill in between.
+	int size = getNumVertices();
+	vector<int> degree (size);
+	vector<int> byDegree (size);
+	for (int v = 0; v < size; v++)
+	{
+		degree[v] = getInDegree(v) + getOutDegree(v);
+		byDegree[v] = v;
+	}
+	stable_sort(byDegree.begin(), byDegree.end(), LessDegree(degree));
+
+	order.clear();
+	order.reserve(size);
+	vector<bool> visited (size, false);
+	vector<int> ns;
+	for (int s = 0; s < size; s++)
+	{
+		if (visited[byDegree[s]])
+			continue;
+
+		unsigned int head = order.size();
+		order.push_back(byDegree[s]);
+		visited[byDegree[s]] = true;
+		for (; head < order.size(); head++)
+		{
+			int v = order[head];
+			ns.clear();
+			set_union(inBegin(v), inEnd(v), outBegin(v), outEnd(v), back_inserter(ns));
+			stable_sort(ns.begin(), ns.end(), LessDegree(degree));
+			for (unsigned int n = 0; n < ns.size(); n++)
+			{
+				if (!visited[ns[n]])
+				{
+					visited[ns[n]] = true;
+					order.push_back(ns[n]);
+				}
+			}
+		}
+	}
+
+	reverse(order.begin(), order.end());
+}
+//------------------------------------------------------------------------------
+void GraphSnapshot::degreeOrder(vector<int> &order) const
+{
+	// hubs first, so the vertices that are touched most share cache lines
+	int size = getNumVertices();
+	vector<int> degree (size);
+	order.resize(size);
+	for (int v = 0; v < size; v++)
+	{
+		degree[v] = -(getInDegree(v) + getOutDegree(v));
+		order[v] = v;
+	}
+	stable_sort(order.begin(), order.end(), LessDegree(degree));
+}
+//------------------------------------------------------------------------------
+void GraphSnapshot::gorderOrder(vector<int> &order, int window) const
+{
+	// A greedy take on Gorder (Wei et al., "Speedup Graph Processing by Graph
+	// Ordering", SIGMOD 2016): the next vertex is the one that scores best
+	// against the last window vertices placed, where a pair scores one for an
+	// edge between them and one for every in-neighbor they share.  Scores
+	// change by one at a time as vertices enter and leave the window, so the
+	// unplaced vertices are kept in one list per score and the best is found
+	// by walking down from the top score (the paper's "unit heap").
+	//
+	// Siblings through a hub would make every update touch most of the
+	// graph, so in-neighbors with more than sqrt(n) out-edges are left out of
+	// the shared in-neighbor count, as in the paper.
+	int size = getNumVertices();
+	order.clear();
+	order.reserve(size);
+	if (size == 0)
+		return;
+
+	int hub = (int) sqrt((double) size) + 1;
+	vector<int> score (size, 0);
+	vector<bool> placed (size, false);
+	vector<int> prev (size, -1), next (size, -1);
+	vector<int> head (1, -1);		// first vertex of each score > 0
+	int top = 0;
+
+	// when nothing in the window has a neighbor left, start again from the
+	// unplaced vertex with the most in-edges
+	vector<int> seeds (size);
+	vector<int> inDegree (size);
+	for (int v = 0; v < size; v++)
+	{
+		seeds[v] = v;
+		inDegree[v] = -getInDegree(v);
+	}
+	stable_sort(seeds.begin(), seeds.end(), LessDegree(inDegree));
+	unsigned int nextSeed = 0;
+
+	for (int step = 0; step < size; step++)
+	{
+		while ((top > 0) && (head[top] < 0))
+			top--;
+
+		int v;
+		if (top > 0)
+			v = head[top];
+		else
+		{
+			while (placed[seeds[nextSeed]])
+				nextSeed++;
+			v = seeds[nextSeed];
+		}
+
+		placed[v] = true;
+		order.push_back(v);
+		if (score[v] > 0)
+			unlink(v, score, prev, next, head);
+
+		// v joins the window, and the vertex placed window steps ago leaves it
+		for (int pass = 0; pass < 2; pass++)
+		{
+			int w = (pass == 0) ? v : ((step >= window) ? order[step - window] : -1);
+			int delta = (pass == 0) ? 1 : -1;
+			if (w < 0)
+				continue;
+
+			for (int side = 0; side < 2; side++)
+			{
+				const int *n = (side == 0) ? outBegin(w) : inBegin(w);
+				const int *nEnd = (side == 0) ? outEnd(w) : inEnd(w);
+				for (; n != nEnd; n++)
+				{
+					if (!placed[*n])
+						bump(*n, delta, score, prev, next, head, top);
+
+					if ((side == 1) && (getOutDegree(*n) <= hub))
+					{
+						for (const int *s = outBegin(*n); s != outEnd(*n); s++)
+						{
+							if (!placed[*s])
+								bump(*s, delta, score, prev, next, head, top);
+						}
+					}
+				}
+			}
+		}
+	}
+}
+//------------------------------------------------------------------------------
+void GraphSnapshot::unlink(int v, vector<int> &score, vector<int> &prev, vector<int> &next, vector<int> &head)
+{
+	// take v out of the list for its score
+	if (prev[v] >= 0)
+		next[prev[v]] = next[v];
+	else
+		head[score[v]] = next[v];
+	if (next[v] >= 0)
+		prev[next[v]] = prev[v];
+}
+//------------------------------------------------------------------------------
+void GraphSnapshot::bump(int v, int delta, vector<int> &score, vector<int> &prev, vector<int> &next, vector<int> &head, int &top)
+{
+	// move v to the list for its new score; score 0 has no list
+	if (score[v] > 0)
+		unlink(v, score, prev, next, head);
+	score[v] += delta;
+	if (score[v] <= 0)
+		return;
+
+	if (score[v] >= (int) head.size())
+		head.resize(score[v] + 1, -1);
+	prev[v] = -1;
+	next[v] = head[score[v]];
+	if (next[v] >= 0)
+		prev[next[v]] = v;
+	head[score[v]] = v;
+	if (score[v] > top)
+		top = score[v];
+}
@@ -0,0 +1,210 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE:  GraphSnapshot.hpp
+*  	DESCRIPTION:  Header file for an immutable compressed sparse row (CSR)
+*					copy of a NiceGraph used by the read-only analyses
+*	URL: http://www.babelgraph.org/
+*/
+
+#ifndef GRAPHSNAPSHOT_HPP_
+#define GRAPHSNAPSHOT_HPP_
+
+#include<vector>
+#include<climits>
+#include<algorithm>
+#include<cstddef>
+
+#include "BitMatrix.hpp"
+#include "CompressedGraph.hpp"
+#include "DistanceMatrix.hpp"
+
+using namespace std;
+
+// Everything the path analyses report, from one search per source (see
+// GraphSnapshot::pathMetrics()).  The vectors are indexed densely.  On a
+// weighted graph distances are sums of weights and there is no histogram,
+// since weights in any unit could need any number of bins.
+struct PathMetrics {
+	vector<double> sums;			// distances from each vertex to all it reaches
+	vector<int> reached;			// how many vertices each one reaches, itself included
+	vector<float> avgPath;			// mean distance to all the others, -1 if it can't reach them all
+	vector<float> closeness;		// mean distance to the ones it reaches, 0 if none
+	vector<float> eccentricity;		// distance to the farthest one it reaches
+	vector<long long> histogram;	// ordered pairs (s != t, t reachable) by hop count, if unweighted
+	float graphAvgPath;				// over all ordered pairs, -1 if the graph is disconnected
+	float diameter;					// largest eccentricity
+};
+
+// Estimates of the path measures from searches into a random sample of
+// pivot vertices (see GraphSnapshot::estimatePathMetrics()), each with the
+// half width of its 95% confidence interval; an error of -1 means too few
+// pivots were reachable to say.  Dense like PathMetrics.
+struct PathEstimate {
+	int pivots;						// searches run
+	vector<float> closeness;		// as in PathMetrics, 0 if no pivot is reachable
+	vector<float> closenessError;
+	float graphAvgPath;				// -1 if the sample shows the graph is disconnected
+	float graphAvgPathError;
+};
+
+// How a PageRank run ended, see GraphKernels::pageRank()
+struct PageRankReport {
+	int iterations;
+	double residual;		// L1 change in the ranks over the last iteration
+	bool converged;			// residual got under the tolerance
+};
+
+// Triangles and clustering for every vertex at once (see
+// GraphSnapshot::clusteringMetrics()), on the undirected view of the graph:
+// two vertices are neighbors if there is an edge either way between them.
+// Dense like PathMetrics.
+struct ClusteringMetrics {
+	vector<int> neighbors;			// size of each vertex's neighborhood
+	vector<long long> triangles;	// triangles each vertex is a corner of
+	vector<float> local;			// as clusteringCoefficient(), 0 with fewer than 2 neighbors
+	long long totalTriangles;
+	double transitivity;			// 3 x triangles / paths of length 2, 0 if there are none
+	double averageClustering;		// mean of local over all the vertices
+};
+
+// A GraphSnapshot stores the adjacency of a graph in contiguous arrays.
+// Vertices are renumbered densely 0..n-1 (in increasing vID order) and every
+// row of neighbors is sorted by dense index, so the analyses can walk the
+// graph without chasing pointers through maps.
+//
+// The snapshot is built by NiceGraph (see NiceGraph::getSnapshot()) and is
+// never modified afterwards.  An undirected edge shows up in the out and in
+// rows of both its ends, so getNumEdges() counts it twice.
+//
+// Because it never changes, a snapshot can be handed to another thread
+// (see NiceGraph::shareSnapshot()) and analysed there while the graph it
+// came from keeps being edited.  getVersion() tells which state of the
+// graph it was taken from.
+//
+// A dense graph also gets a BitMatrix copy of its rows (see
+// BitMatrix::worthBuilding()); the analyses that have a bit-parallel
+// version use it when it is there.
+
+class GraphSnapshot {
+
+	friend class NiceGraph;
+
+	public:
+	GraphSnapshot();
+
+	// Sizes
+	int getNumVertices() const;
+	int getNumEdges() const;		// directed arcs
+	unsigned long getVersion() const;	// NiceGraph::getVersion() when the snapshot was built
+
+	// Dense index <--> vertex ID mapping
+	int getVID(int denseIndex) const;
+	int getDenseIndex(int vertexID) const;	// returns -1 if there is no such vertex
+	unsigned int getGeneration(int denseIndex) const;	// NiceGraph::getVertexGeneration() of the vertex
+
+	// Adjacency rows, all indices are dense
+	const int * outBegin(int v) const { return outNeighbors.data() + outOffsets[v]; }
+	const int * outEnd(int v) const { return outNeighbors.data() + outOffsets[v+1]; }
+	const float * outWeights(int v) const { return outWeight.data() + outOffsets[v]; }
+	const int * inBegin(int v) const { return inNeighbors.data() + inOffsets[v]; }
+	const int * inEnd(int v) const { return inNeighbors.data() + inOffsets[v+1]; }
+	int getOutDegree(int v) const { return outOffsets[v+1] - outOffsets[v]; }
+	int getInDegree(int v) const { return inOffsets[v+1] - inOffsets[v]; }
+	bool testFromToConnected(int from, int to) const;
+
+	// The same rows as ranges, the form the kernels in GraphKernels.hpp take
+	struct Row {
+		typedef const int * const_iterator;
+		const int *first, *last;
+		const int * begin() const { return first; }
+		const int * end() const { return last; }
+	};
+	Row outRow(int v) const { Row r = {outBegin(v), outEnd(v)}; return r; }
+	Row inRow(int v) const { Row r = {inBegin(v), inEnd(v)}; return r; }
+
+	const BitMatrix * getBitMatrix() const;	// NULL unless the graph is dense
+	// NULL unless NiceGraph::setCompressedRows() is on; pageRank(),
+	// bfsDistances() and countTriangles() then read its rows
+	const CompressedGraph * getCompressedGraph() const;
+
+	size_t bytes() const;	// memory held, in bytes, including the bit matrix and packed rows
+
+	// Analyses, results are indexed densely
+	PageRankReport pageRank(vector<float> &rank, float damping = 0.85, double tolerance = 1e-6, int maxIterations = 100) const;
+	void allPairsFW(DistanceMatrix &distance) const;	// weighted lengths, see DistanceMatrix
+
+	// Shortest paths, one search per source spread over the available cores:
+	// BFS when every weight is 1, Dijkstra on the weights otherwise (or, for
+	// a dense weighted graph, rows of allPairsFW() computed up front).  Each
+	// search is folded into the per-source totals as it finishes, so the
+	// n x n distances are never kept.  Returns false, with nothing reached,
+	// if a weight is negative.
+	bool pathMetrics(PathMetrics &metrics) const;
+	// the rest of metrics from its sums, reached and eccentricity, for the
+	// pathMetrics() of the other layouts too
+	static void averagePathMetrics(PathMetrics &metrics);
+	bool hasUnitWeights() const;
+	bool hasNegativeWeights() const;
+	// HUGE_VAL where unreachable; towards gives the distances to source instead
+	void dijkstraDistances(int source, vector<double> &distance, bool towards = false) const;
+
+	// The same from a sample, for graphs too big for a search per vertex
+	// (after Eppstein and Wang): a search into each of k random pivots, in
+	// rounds of ESTIMATE_ROUND run in parallel.  Each vertex's closeness is
+	// its mean distance to the pivots it reaches, and the graph average the
+	// mean of the pivots' averages.  Give pivots = k, or pivots = 0 and a
+	// targetError (eg. 0.05 for 5%): rounds are then added until both the
+	// graph average and the mean closeness are that close, relative to
+	// their values.  All pivots gives the exact values.
+	enum {ESTIMATE_ROUND = 16};
+	void estimatePathMetrics(PathEstimate &estimate, int pivots, float targetError = 0, unsigned int seed = 1) const;
+
+	// Triangles and clustering coefficients of every vertex in one pass.
+	// Vertices are ranked by degree and each only keeps its higher ranked
+	// neighbors, so every triangle is found once, from its lowest ranked
+	// corner, by marking that corner's neighbors and walking the middle
+	// one's; the hubs, which make the per vertex loop slow, keep the fewest.
+	// Spread over the available cores with a marker array per thread.
+	void clusteringMetrics(ClusteringMetrics &metrics) const;
+	float clusteringCoefficient(int v) const;	// just one vertex
+	long long countTriangles() const;		// undirected graphs, see GraphKernels::countTriangles()
+	void bfsDistances(int source, vector<int> &distance) const;	// hop counts, -1 where unreachable
+
+	// Vertex orderings for NiceGraph::reorder(), each lists the dense indices
+	// in their new order
+	void rcmOrder(vector<int> &order) const;		// reverse Cuthill-McKee
+	void degreeOrder(vector<int> &order) const;		// most edges first
+	void gorderOrder(vector<int> &order, int window = 5) const;
+
+	private:
+	unsigned long version;
+	vector<int> outOffsets, outNeighbors;
+	vector<float> outWeight;
+	vector<int> inOffsets, inNeighbors;
+	vector<int> denseToVID;
+	vector<int> vidToDense;
+	vector<unsigned int> denseGeneration;
+	BitMatrix bits;			// empty unless dense
+	CompressedGraph packed;	// empty unless asked for
+
+	void reverseDijkstraDistances(int target, vector<double> &distance) const;
+
+	// score lists for gorderOrder()
+	static void unlink(int v, vector<int> &score, vector<int> &prev, vector<int> &next, vector<int> &head);
+	static void bump(int v, int delta, vector<int> &score, vector<int> &prev, vector<int> &next, vector<int> &head, int &top);
+
+};
+
+#endif // GRAPHSNAPSHOT_HPP_
@@ -22,6 +22,7 @@
 */
 
 #include "GraphWidget.hpp"
+#include "GraphKernels.hpp"
 
 GraphWidget::GraphWidget(QWidget *parent)
      : QGLWidget(parent)
@@ -41,6 +42,7 @@ GraphWidget::GraphWidget(QWidget *parent)
 	setDefaultPlot();
 
 	g = new NiceGraph();
+	compressedRows = false;
 
 	selfOrganizeDelay = 1000;
 	selfOrganizeTimer = new QTimer(this);
@@ -51,8 +53,24 @@ GraphWidget::GraphWidget(QWidget *parent)
 	currentVertex = -1;
 	highlightV = -1;
 
+	indexCursor = 0;
 	updateGraphIndices();
 
+	// analyses run in the background on a snapshot of the graph, see updateAnalysis()
+	analysis.version = 0;
+	analysisStarted = 0;
+	analysisQueued = false;
+	rankPushes = -1;
+	rankReport.iterations = 0;
+	rankReport.residual = 0;
+	rankReport.converged = false;
+	analysisWatcher = new QFutureWatcher<AnalysisResults>(this);
+	connect(analysisWatcher, SIGNAL(finished()), this, SLOT(collectAnalysis()));
+	estimate.version = 0;
+	estimateStarted = 0;
+	estimateWatcher = new QFutureWatcher<EstimateResults>(this);
+	connect(estimateWatcher, SIGNAL(finished()), this, SLOT(collectEstimate()));
+
 	QObject::connect(this,SIGNAL(graphChanged()),this,SLOT(updateGraphIndices()));
 	QObject::connect(this,SIGNAL(graphChanged()),this,SLOT(updateGL()));
 	//QObject::connect(this,SIGNAL(graphChanged()),this,SLOT(updateAnalysis())); <-- too intensive, user should call it
@@ -121,6 +139,7 @@ void GraphWidget::selfOrganizeOneStep()
 {
 	if (selfOrganize)
 	{
+		copyMapped();
 		g->selfOrganize (autoRepulsion, 0.05, .1);
 		updateGL();
 	}
@@ -183,12 +202,32 @@ void GraphWidget::set3DView()
 
 void GraphWidget::makeUndirected()
 {
+	copyMapped();
 	g->makeUndirected();
 	emit graphChanged();
 }
+void GraphWidget::reorder(int strategy)
+{
+	// the graph itself is the same, so nothing goes stale
+	g->reorder(strategy);
+}
+void GraphWidget::setCompressedRows(bool on)
+{
+	// likewise; the analyses just read their rows from somewhere else
+	compressedRows = on;
+	g->setCompressedRows(on);
+}
+double GraphWidget::getCompressedBytesPerArc()
+{
+	if (mapped)
+		return 0;	// read from the file as it is
+	const CompressedGraph *packed = g->getSnapshot().getCompressedGraph();
+	return packed ? packed->bytesPerEdge() : 0;
+}
 
 void GraphWidget::refresh2DLayout(int index)
 {
+	copyMapped();
 	switch(index)
 	{
 		case 0:			// random layout
@@ -215,6 +254,7 @@ void GraphWidget::refresh2DLayout(int index)
 
 void GraphWidget::refresh3DLayout(int index) 
 {
+	copyMapped();
 	switch(index)
 	{
 
@@ -247,25 +287,276 @@ void GraphWidget::refresh3DLayout(int index)
 }
 void GraphWidget::updateAnalysis()
 {
-	g->avgShortestPathMatrix(shortestPaths);
-	g->getPageRank(pRank);
-	g->getClosenessCentrality(cCentrality);
+	// the analysis works on its own reference to an immutable snapshot, so the
+	// graph can go on being edited (or even replaced) while it runs
+	if (analysisWatcher->isRunning())
+	{
+		analysisQueued = true;		// start again when this one is done
+		return;
+	}
+
+	analysisQueued = false;
+
+	if (mapped)
+	{
+		// nothing to repair, the file never changes
+		rankPushes = -1;
+		analysisStarted = g->getVersion();
+		analysisWatcher->setFuture(QtConcurrent::run(&GraphWidget::runMappedAnalysis, mapped, analysisStarted));
+		return;
+	}
+
+	// PageRank is repaired from the journal when it can be, which for a few
+	// edits is far cheaper than running it again; only when that fails does
+	// the analysis run it in full
+	bool rankCurrent = pageRank.update(*g);
+	rankPushes = rankCurrent ? pageRank.getPushes() : -1;
+
+	analysisStarted = g->getVersion();
+	analysisWatcher->setFuture(QtConcurrent::run(&GraphWidget::runAnalysis, g->shareSnapshot(), analysisStarted,
+		g->getJournal().getHead(), !rankCurrent));
+}
+AnalysisResults GraphWidget::runAnalysis(shared_ptr<const GraphSnapshot> snapshot, unsigned long version,
+	unsigned long cursor, bool runPageRank)
+{
+	// runs in a worker thread, must not touch anything but the snapshot
+	AnalysisResults results;
+	results.version = version;
+
+	results.snapshot = snapshot;
+
+	// one search per source serves all the path measures, and one pass over
+	// the triangles all the clustering ones
+	snapshot->pathMetrics(results.paths);
+	snapshot->clusteringMetrics(results.clustering);
+	GraphKernels::degreeStats(*snapshot, results.minDegree, results.maxDegree, results.meanDegree);
+	if (runPageRank)
+	{
+		vector<float> rank;
+		results.rankReport = snapshot->pageRank(rank);
+		results.pRank.reset(snapshot, rank, cursor);
+	}
+
+	return results;
+}
+AnalysisResults GraphWidget::runMappedAnalysis(shared_ptr<const MappedGraph> mapped, unsigned long version)
+{
+	// the same off the mapped rows, except clustering, which wants the
+	// undirected view only a snapshot builds
+	AnalysisResults results;
+	results.version = version;
+	results.mapped = mapped;
+
+	mapped->pathMetrics(results.paths);
+	results.rankReport = mapped->pageRank(results.rank);
+	GraphKernels::degreeStats(*mapped, results.minDegree, results.maxDegree, results.meanDegree);
+
+	return results;
+}
+void GraphWidget::collectAnalysis()
+{
+	// versions are drawn from one counter for all graphs, so only the one
+	// this graph's job started on says the results are about this graph
+	AnalysisResults results = analysisWatcher->result();
+	if (results.version != analysisStarted)
+	{
+		if (analysisQueued)
+			updateAnalysis();
+		emit analysisFinished();
+		return;
+	}
+
+	analysis = results;
+	if (analysis.mapped)
+		rankReport = analysis.rankReport;
+
+	// a full PageRank run starts it over, caught up with any edits made meanwhile
+	if (analysis.pRank.isValid())
+	{
+		pageRank = analysis.pRank;
+		pageRank.update(*g);
+		rankReport = analysis.rankReport;
+		analysis.pRank = IncrementalPageRank();
+	}
+
+	if (analysisQueued && analysisIsStale())
+		updateAnalysis();
+
+	emit analysisFinished();
+}
+bool GraphWidget::analysisIsRunning()
+{
+	return analysisWatcher->isRunning();
+}
+bool GraphWidget::analysisIsStale()
+{
+	return analysis.version != g->getVersion();
+}
+int GraphWidget::analysisIndex(int index)
+{
+	if (analysis.mapped)
+		return (analysis.mapped == mapped) ? mappedVertex(index) : -1;
+	if (!analysis.snapshot)
+		return -1;	// none run yet
+	return snapshotIndex(*analysis.snapshot, index);
+}
+int GraphWidget::snapshotIndex(const GraphSnapshot &snapshot, int index)
+{
+	// the ID may have been freed and given to a new vertex since, which the
+	// results know nothing about
+	int v = snapshot.getDenseIndex(index);
+	if ((v < 0) || !g->validVID(index) || (snapshot.getGeneration(v) != g->getVertexGeneration(index)))
+		return -1;
+	return v;
 }
 float GraphWidget::getAvgShortestPath(int index)
 {
-	return shortestPaths[index];
+	int v = analysisIndex(index);
+	return (v < 0) ? -1 : analysis.paths.avgPath[v];
 }
 float GraphWidget::getPageRank(int index)
 {
-	return pRank[index];
+	if (analysis.mapped)
+	{
+		int v = analysisIndex(index);
+		return (v < 0) ? -1 : analysis.rank[v];
+	}
+	// ranks that haven't caught up with every edit yet aren't shown; the
+	// next analysis brings them up to date
+	if (!pageRank.isValid() || (pageRank.getCursor() != g->getJournal().getHead()))
+		return -1;
+	return pageRank.getRank(index);
 }
 float GraphWidget::getCCentrality(int index)
 {
-	return cCentrality[index];
+	int v = analysisIndex(index);
+	return (v < 0) ? -1 : analysis.paths.closeness[v];
+}
+float GraphWidget::getEccentricity(int index)
+{
+	int v = analysisIndex(index);
+	return (v < 0) ? -1 : analysis.paths.eccentricity[v];
+}
+float GraphWidget::getGraphAvgShortestPath()
+{
+	return (analysis.snapshot || analysis.mapped) ? analysis.paths.graphAvgPath : 0;
+}
+float GraphWidget::getDiameter()
+{
+	return (analysis.snapshot || analysis.mapped) ? analysis.paths.diameter : 0;
+}
+vector<long long> GraphWidget::getDistanceHistogram()
+{
+	return analysis.paths.histogram;
+}
+void GraphWidget::getDegreeStats(int &minDegree, int &maxDegree, double &meanDegree)
+{
+	if (!analysis.snapshot && !analysis.mapped)
+	{
+		minDegree = maxDegree = 0;
+		meanDegree = 0;
+		return;
+	}
+	minDegree = analysis.minDegree;
+	maxDegree = analysis.maxDegree;
+	meanDegree = analysis.meanDegree;
+}
+PageRankReport GraphWidget::getPageRankReport()
+{
+	return rankReport;
+}
+int GraphWidget::getPageRankPushes()
+{
+	return rankPushes;
+}
+void GraphWidget::estimatePaths(int pivots, float targetError)
+{
+	if (estimateWatcher->isRunning())
+		return;		// one at a time; the menu is disabled meanwhile
+	if (mapped)
+	{
+		// the sampling needs a snapshot, so a mapped file has no estimate
+		estimate = EstimateResults();
+		emit estimateFinished();
+		return;
+	}
+
+	estimateStarted = g->getVersion();
+	estimateWatcher->setFuture(QtConcurrent::run(&GraphWidget::runEstimate, g->shareSnapshot(), estimateStarted, pivots, targetError));
+}
+EstimateResults GraphWidget::runEstimate(shared_ptr<const GraphSnapshot> snapshot, unsigned long version, int pivots, float targetError)
+{
+	// runs in a worker thread, like runAnalysis()
+	EstimateResults results;
+	results.version = version;
+	results.snapshot = snapshot;
+	snapshot->estimatePathMetrics(results.paths, pivots, targetError);
+	return results;
+}
+void GraphWidget::collectEstimate()
+{
+	// likewise
+	EstimateResults results = estimateWatcher->result();
+	if (results.version == estimateStarted)
+		estimate = results;
+	emit estimateFinished();
+}
+bool GraphWidget::estimateIsRunning()
+{
+	return estimateWatcher->isRunning();
+}
+int GraphWidget::getEstimatePivots()
+{
+	return estimate.snapshot ? estimate.paths.pivots : 0;
+}
+float GraphWidget::getEstimatedAvgShortestPath(float &error)
+{
+	if (!estimate.snapshot)
+	{
+		error = -1;
+		return 0;
+	}
+	error = estimate.paths.graphAvgPathError;
+	return estimate.paths.graphAvgPath;
+}
+float GraphWidget::getEstimatedCCentrality(int index, float &error)
+{
+	int v = estimate.snapshot ? snapshotIndex(*estimate.snapshot, index) : -1;
+	if (v < 0)
+	{
+		error = -1;
+		return 0;
+	}
+	error = estimate.paths.closenessError[v];
+	return estimate.paths.closeness[v];
 }
 float GraphWidget::getClusteringCoefficient(int index)
 {
-	return g->getClusteringCoefficient(index);	
+	int v = analysis.mapped ? -1 : analysisIndex(index);
+	return (v < 0) ? -1 : analysis.clustering.local[v];
+}
+float GraphWidget::getTransitivity()
+{
+	return analysis.snapshot ? analysis.clustering.transitivity : 0;
+}
+float GraphWidget::getAvgClusteringCoefficient()
+{
+	return analysis.snapshot ? analysis.clustering.averageClustering : 0;
+}
+long long GraphWidget::getNumTriangles()
+{
+	return analysis.snapshot ? analysis.clustering.totalTriangles : 0;
+}
+void GraphWidget::getRelatedVertices(int index, int k, vector<pair<int,float> > &related)
+{
+	// cheap enough to run on the spot, unlike the analyses, but only on a
+	// snapshot; a mapped file has none
+	if (mapped)
+	{
+		related.clear();
+		return;
+	}
+	g->getRelatedVertices(index, k, related);
 }
 void GraphWidget::replot(float xmin, float xmax, float ymin, float ymax, float zmin, float zmax, float radius)
 {
@@ -370,47 +661,48 @@ void GraphWidget::paintGL()
 	}
 
 	// paint the graph if it exists
-	if (g != NULL)
+	if (mapped)
+		paintMappedGraph();
+	else if (g != NULL)
 	{
 		paintGraph();
 	}
 }
 void GraphWidget::paintGraph()
 {
+	// read the coordinates straight out of the graph's position arrays
+	const float *X = g->getXPositions();
+	const float *Y = g->getYPositions();
+	const float *Z = g->getZPositions();
+
 	// paint the vertices
 	for (unsigned int v = 0; v < vertexIndexList.size(); v++)
 	{
 		int index = vertexIndexList[v];
-		vector<float> tempXYZ (3);
-		g->getXYZPos(index, tempXYZ);
 		COLOR color = colorList[ (g->getVertexColor(index)) ];
 		if (index == highlightV)
 		{	
 			color.r*=0.65;color.g*=0.65;color.b*=0.65;color.a*=0.65;
 		}
 		glColor4f(color.r,color.g,color.b,color.a);
-		float Z;
-		if (is3D)
-			Z = tempXYZ[2];
-		else
-			Z = 0;
-		drawSphere(nodeRadius, tempXYZ[0], tempXYZ[1] , Z);
+		drawSphere(nodeRadius, X[index], Y[index] , is3D ? Z[index] : 0);
 	}
 
 	// paint the edges
+	COLOR edgeColor = colorList[GREEN];
 	for (unsigned int e = 0; e < edgeIndexList.size(); e++)
 	{
-		int index = edgeIndexList[e];
-		vector<float> tFrom (3), tTo(3);
-		g->getEndpoints (index, tFrom, tTo);	// if this edge ID exists
+		if (!g->validEID(edgeIndexList[e]))		// if this edge ID exists
+			continue;
+		int from, to;
+		g->getEdgeVertices (edgeIndexList[e], from, to);
 			
-		COLOR color = colorList[GREEN];
-		glColor4f(color.r, color.g, color.b, color.a);
+		glColor4f(edgeColor.r, edgeColor.g, edgeColor.b, edgeColor.a);
 		float Zfrom, Zto;
 		if (is3D)
 		{
-			Zfrom = tFrom[2];
-			Zto = tTo[2];
+			Zfrom = Z[from];
+			Zto = Z[to];
 		}
 		else
 		{
@@ -418,21 +710,74 @@ void GraphWidget::paintGraph()
 			Zto = 0;
 		}
 		glBegin(GL_LINES);
-		glVertex3f(tFrom[0], tFrom[1], Zfrom);
-		glVertex3f(tTo[0], tTo[1], Zto);		
+		glVertex3f(X[from], Y[from], Zfrom);
+		glVertex3f(X[to], Y[to], Zto);		
 		glEnd();
 
 		if (g->checkDirected())		//paint arrows if edges are directed
 		{
 			vector<float> n(3);
-			float vx =tTo[0]-tFrom[0];
-			float vy =tTo[1]-tFrom[1];
-			float vz =tTo[2]-tFrom[2];
+			float vx =X[to]-X[from];
+			float vy =Y[to]-Y[from];
+			float vz =Z[to]-Z[from];
 			float mag = sqrt (vx*vx+vy*vy+vz*vz);
 			n[0]=vx/mag;
 			n[1]=vy/mag;
 			n[2]=vz/mag;
-			drawArrow(tTo[0], tTo[1], Zto, n);
+			drawArrow(X[to], Y[to], Zto, n);
+		}
+	}
+}
+void GraphWidget::paintMappedGraph()
+{
+	// the same from the rows of the file, where every vertex has the default color
+	const float *X = mapped->getXPositions();
+	const float *Y = mapped->getYPositions();
+	const float *Z = mapped->getZPositions();
+	int size = mapped->getNumVertices();
+	bool directed = mapped->checkDirected();
+
+	for (int v = 0; v < size; v++)
+	{
+		COLOR color = colorList[YELLOW];
+		if (mapped->getVID(v) == highlightV)
+		{	
+			color.r*=0.65;color.g*=0.65;color.b*=0.65;color.a*=0.65;
+		}
+		glColor4f(color.r,color.g,color.b,color.a);
+		drawSphere(nodeRadius, X[v], Y[v] , is3D ? Z[v] : 0);
+	}
+
+	COLOR edgeColor = colorList[GREEN];
+	for (int from = 0; from < size; from++)
+	{
+		MappedGraph::Row out = mapped->outRow(from);
+		for (const int *u = out.begin(); u != out.end(); u++)
+		{
+			int to = *u;
+			if (!directed && (to < from))
+				continue;	// an undirected edge is in both rows
+
+			glColor4f(edgeColor.r, edgeColor.g, edgeColor.b, edgeColor.a);
+			float Zfrom = is3D ? Z[from] : 0;
+			float Zto = is3D ? Z[to] : 0;
+			glBegin(GL_LINES);
+			glVertex3f(X[from], Y[from], Zfrom);
+			glVertex3f(X[to], Y[to], Zto);
+			glEnd();
+
+			if (directed)
+			{
+				vector<float> n(3);
+				float vx =X[to]-X[from];
+				float vy =Y[to]-Y[from];
+				float vz =Z[to]-Z[from];
+				float mag = sqrt (vx*vx+vy*vy+vz*vz);
+				n[0]=vx/mag;
+				n[1]=vy/mag;
+				n[2]=vz/mag;
+				drawArrow(X[to], Y[to], Zto, n);
+			}
 		}
 	}
 }
@@ -511,24 +856,53 @@ void GraphWidget::normalizeAngle(int *angle)
      while (*angle > 360 * 16)
          *angle -= 360 * 16;
 }
-void GraphWidget::clearGraph()
+void GraphWidget::replaceGraph()
 {
-
-	if (g)
-		delete g;
-
+	// every new graph starts from here, with the options set on the old one
+	delete g;
 	g = new NiceGraph();
-
+	g->setCompressedRows(compressedRows);
+	mapped.reset();
+	mappedFile.clear();
+	mappedIndex.clear();
+
+	// the results were of the old graph, and so are any jobs still running
+	analysis = AnalysisResults();
+	estimate = EstimateResults();
+	analysisStarted = estimateStarted = 0;
+	pageRank = IncrementalPageRank();
+	rankPushes = -1;
+	rankReport.iterations = 0;
+	rankReport.residual = 0;
+	rankReport.converged = false;
+}
+void GraphWidget::copyMapped()
+{
+	// the mapped file becomes an ordinary graph, with the same IDs; any
+	// results read from the mapping lose their vertices, like after an edit
+	if (!mapped)
+		return;
+	g->loadFromMappedFile(mappedFile);
+	mapped.reset();
+	mappedFile.clear();
+	mappedIndex.clear();
+}
+int GraphWidget::mappedVertex(int index)
+{
+	if ((index < 0) || (index >= (int) mappedIndex.size()))
+		return -1;
+	return mappedIndex[index];
+}
+void GraphWidget::clearGraph()
+{
+	replaceGraph();
 
 	emit graphChanged();
 
 }
 void GraphWidget::makeEmpty(int num)
 {
-	if (g)
-		delete g;
-
-	g = new NiceGraph();
+	replaceGraph();
 
 	g->makeEmptyGraph(num);
 	g->randomLayoutAll(xMin,xMax,yMin,yMax,zMin,zMax);
@@ -538,10 +912,7 @@ void GraphWidget::makeEmpty(int num)
 }
 void GraphWidget::makeComplete(int num)
 {
-	if (g)
-		delete g;
-
-	g = new NiceGraph();
+	replaceGraph();
 	g->makeCompleteGraph(num);
 	g->randomLayoutAll(xMin,xMax,yMin,yMax,zMin,zMax);
 
@@ -550,10 +921,7 @@ void GraphWidget::makeComplete(int num)
 }
 void GraphWidget::makeBinaryTree(int generations)
 {
-	if (g)
-		delete g;
-
-	g = new NiceGraph();
+	replaceGraph();
 	g->makeBinaryTreeGraph(pow(2.0,generations) - 1);
 	g->randomLayoutAll(xMin,xMax,yMin,yMax,zMin,zMax);
 
@@ -561,20 +929,14 @@ void GraphWidget::makeBinaryTree(int generations)
 }
 void GraphWidget::makeRandom(int num, double density)
 {
-	if (g)
-		delete g;
-
-	g = new NiceGraph();
+	replaceGraph();
 	g->makeRandomGraph(num,density);
 	g->randomLayoutAll(xMin,xMax,yMin,yMax,zMin,zMax);
 	emit graphChanged();
 }
 void GraphWidget::makekRegular(int num, int k)
 {
-	if (g)
-		delete g;
-
-	g = new NiceGraph();
+	replaceGraph();
 	g->makeKRegularGraph(num,k);
 	g->randomLayoutAll(xMin,xMax,yMin,yMax,zMin,zMax);
 	emit graphChanged();
@@ -583,86 +945,239 @@ void GraphWidget::makekRegular(int num, int k)
 
 void GraphWidget::makeStrangersBanquet(int num, int groups, float density, float mu)
 {
-	if (g)
-		delete g;
-	g = new NiceGraph();
+	replaceGraph();
 	g->makeStrangersBanquetGraph(num, groups, density, mu);
 	g->randomLayoutAll(xMin,xMax,yMin,yMax,zMin,zMax);
 	emit graphChanged();
 }
-vector<int> GraphWidget::getOutNeighborIndexList(int index)
+void GraphWidget::getOutNeighbors(int index, vector<int> &neighbors)
 {
-	vector<int> list = g->getOutNeighborList(index);
-	return list;
+	neighbors.clear();
+	if (mapped)
+	{
+		int v = mappedVertex(index);
+		if (v < 0)
+			return;
+		MappedGraph::Row out = mapped->outRow(v);
+		for (const int *n = out.begin(); n != out.end(); n++)
+			neighbors.push_back(mapped->getVID(*n));
+		return;
+	}
+
+	NeighborRange out = g->getOutNeighbors(index);
+	neighbors.assign(out.begin(), out.end());
 }
 int GraphWidget::getInDegree(int index)
 {
+	// an undirected file has every edge in the in rows as well
+	if (mapped)
+		return (mappedVertex(index) < 0) ? 0 : mapped->getInDegree(mappedVertex(index));
 	return g->getInDegree(index);
 }
 int GraphWidget::getOutDegree(int index)
 {
+	if (mapped)
+		return (mappedVertex(index) < 0) ? 0 : mapped->getOutDegree(mappedVertex(index));
 	return g->getOutDegree(index);
 
 }
 int GraphWidget::getDegree(int index)
 {
+	if (mapped && mapped->checkDirected())
+		return getInDegree(index) + getOutDegree(index);
+	if (mapped)
+		return getOutDegree(index);
 	return g->getDegree(index);
 }
-void GraphWidget::addVertex(string name)
+int GraphWidget::addVertex(string name)
 {
+	copyMapped();
+
+	int id;
 	if (g)
-		g->addVertex(name);
+		id = g->addVertex(name);
 	else {
 		g->makeEmptyGraph(0);
-		g->addVertex(name);
+		id = g->addVertex(name);
 	}
 
-	g->randomLayout(g->getNumVertices() - 1,xMin, xMax, yMin, yMax, zMin, zMax);
+	g->randomLayout(id,xMin, xMax, yMin, yMax, zMin, zMax);
+	emit graphChanged();
+	return id;
+}
+void GraphWidget::removeVertex(int index)
+{
+	copyMapped();
+	if (!g->validVID(index))
+		return;
+
+	g->removeVertex(index);
+
+	if (highlightV == index)
+		highlightV = -1;
+
 	emit graphChanged();
 }
 void GraphWidget::removeEdge(int from, int to)
 {
+	copyMapped();
 	g->removeEdge(from,to);
 	emit graphChanged();
 }
 
 void GraphWidget::addEdge(int from, int to)
 {
+	copyMapped();
 	g->addEdge(from,to);
 	emit graphChanged();
 	
 }
 bool GraphWidget::isValidVID(int index)
 {
-
+	if (mapped)
+		return mappedVertex(index) >= 0;
 	return g->validVID(index);
 
 }
+void GraphWidget::getVertexIDs(vector<int> &list)
+{
+	list = vertexIndexList;
+}
+int GraphWidget::getVertexIDLimit()
+{
+	if (mapped)
+		return mappedIndex.size();
+	return g->getVertexIDLimit();
+}
 void GraphWidget::saveFile(string filename)
 {
-	g->saveToFile(filename);
+	// written from the graph, even a mapped one; that may be the very file,
+	// so nothing may still be reading the mapping
+	if (mapped)
+	{
+		analysisWatcher->waitForFinished();
+		copyMapped();
+	}
+	if (isMappedFile(filename))
+		g->saveToMappedFile(filename);
+	else
+		g->saveToFile(filename);
 }
 void GraphWidget::loadFile(string filename)
 {
-	if (g)
-		delete g;
-	g = new NiceGraph();
-	g->loadFromFile(filename);
+	replaceGraph();
+	if (isMappedFile(filename))
+	{
+		// nothing is read until it is shown or analysed, see MappedGraph
+		shared_ptr<MappedGraph> file (new MappedGraph());
+		if (file->open(filename))
+		{
+			mapped = file;
+			mappedFile = filename;
+			for (int v = 0; v < mapped->getNumVertices(); v++)
+			{
+				int id = mapped->getVID(v);
+				if (id >= (int) mappedIndex.size())
+					mappedIndex.resize(id + 1, -1);
+				mappedIndex[id] = v;
+			}
+		}
+		else
+			cout << "ERROR: Can't map " << filename << " as a BabelGraph CSR file" << endl;
+	}
+	else
+		g->loadFromFile(filename);
 
 	emit graphChanged();
 }
-int GraphWidget::getNumV() { return g->getNumVertices(); }
-int GraphWidget::getNumE() { return g->getNumEdges(); }
-string GraphWidget::getName(int index) { return g->getVertexName(index); }
-void GraphWidget::setName(int index, string name) {g->setVertexName(index,name); updateGL();}
-int GraphWidget::getColor(int index) {return g->getVertexColor(index); }
-void GraphWidget::setColor(int index, int color) { g->setVertexColor(index,color); updateGL(); }
+bool GraphWidget::isMappedFile(const string &filename)
+{
+	// binary CSR, see MappedGraph; anything else is read as a .bgx
+	string extension = ".bgcsr";
+	return (filename.size() >= extension.size())
+		&& (filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0);
+}
+// a mapped file has neither names nor colors, so its vertices get the ones
+// NiceGraph::loadFromMappedFile() gives them
+int GraphWidget::getNumV() { return mapped ? mapped->getNumVertices() : g->getNumVertices(); }
+int GraphWidget::getNumE() { return mapped ? mapped->getNumEdges() / (mapped->checkDirected() ? 1 : 2) : g->getNumEdges(); }
+string GraphWidget::getName(int index) { return mapped ? " " : g->getVertexName(index); }
+void GraphWidget::setName(int index, string name) { copyMapped(); g->setVertexName(index,name); emit graphChanged(); }
+int GraphWidget::getColor(int index) {return mapped ? (int) YELLOW : g->getVertexColor(index); }
+void GraphWidget::setColor(int index, int color) { copyMapped(); g->setVertexColor(index,color); emit graphChanged(); }
+bool GraphWidget::canUndo() { return g->canUndo(); }
+bool GraphWidget::canRedo() { return g->canRedo(); }
+unsigned long GraphWidget::getJournalHead() { return g->getJournal().getHead(); }
+bool GraphWidget::getChangesSince(unsigned long cursor, vector<GraphChange> &changes)
+{
+	return g->getJournal().getChangesSince(cursor, changes);
+}
+void GraphWidget::undo()
+{
+	if (g->undo())
+		emit graphChanged();
+}
+void GraphWidget::redo()
+{
+	if (g->redo())
+		emit graphChanged();
+}
 void GraphWidget::updateGraphIndices()
 {
-	edgeIndexList.clear();
-	vertexIndexList.clear();
-	g->getEdgeIndexList(edgeIndexList);
-	g->getVertexIndexList(vertexIndexList);
+	if (mapped)
+	{
+		// the vertices are all there is to list, and they never change
+		indexCursor = g->getJournal().getHead();
+		edgeIndexList.clear();
+		vertexIndexList.clear();
+		for (unsigned int id = 0; id < mappedIndex.size(); id++)
+			if (mappedIndex[id] >= 0)
+				vertexIndexList.push_back(id);
+		if (mappedVertex(highlightV) < 0)
+			highlightV = -1;
+		return;
+	}
+
+	// catch up with the journal when only a few things changed; a new graph,
+	// or more changes than the lists are long, means starting over
+	vector<GraphChange> changes;
+	bool incremental = g->getJournal().getChangesSince(indexCursor, changes)
+		&& (changes.size() < vertexIndexList.size() + edgeIndexList.size());
+	indexCursor = g->getJournal().getHead();
+
+	if (!incremental)
+	{
+		edgeIndexList.clear();
+		vertexIndexList.clear();
+		g->getEdgeIndexList(edgeIndexList);
+		g->getVertexIndexList(vertexIndexList);
+	}
+	else
+	{
+		// both lists are kept in increasing ID order, like the full rebuild
+		for (unsigned int c = 0; c < changes.size(); c++)
+		{
+			vector<int> &list = ((changes[c].kind == GraphChange::VERTEX_ADDED) || (changes[c].kind == GraphChange::VERTEX_REMOVED))
+				? vertexIndexList : edgeIndexList;
+			vector<int>::iterator at = lower_bound(list.begin(), list.end(), changes[c].id);
+
+			switch (changes[c].kind)
+			{
+				case GraphChange::VERTEX_ADDED:
+				case GraphChange::EDGE_ADDED:
+					list.insert(at, changes[c].id);
+					break;
+				case GraphChange::VERTEX_REMOVED:
+				case GraphChange::EDGE_REMOVED:
+					if ((at != list.end()) && (*at == changes[c].id))
+						list.erase(at);
+					break;
+			}
+		}
+	}
+
+	if ((highlightV >= 0) && !g->validVID(highlightV))
+		highlightV = -1;
 }
 void GraphWidget::initializeColors()
 {
@@ -28,6 +28,8 @@
 #include <QWheelEvent>
 #include <QtGui>
 #include <QtOpenGL>
+#include <QFutureWatcher>
+#include <QtConcurrentRun>
 #ifdef __APPLE__
   #include <OpenGL/glu.h>
   #include <OpenGL/gl.h>
@@ -43,6 +45,8 @@
 #include <string>
 #include <vector>
 #include "NiceGraph.hpp"
+#include "MappedGraph.hpp"
+#include "IncrementalPageRank.hpp"
 
 typedef struct
 {
@@ -55,6 +59,32 @@ typedef struct {
    GLfloat r,g,b,a;
 } COLOR;
 
+// results of one background analysis, tagged with the graph version they
+// describe.  They are indexed densely, so the snapshot they came from is
+// kept to look vertex IDs up in.  PageRank is only there when it had to be
+// run in full, see GraphWidget::updateAnalysis().  An analysis of a mapped
+// file has the file instead of a snapshot, its PageRank in rank, and no
+// clustering.
+typedef struct {
+	unsigned long version;
+	shared_ptr<const GraphSnapshot> snapshot;
+	shared_ptr<const MappedGraph> mapped;
+	PathMetrics paths;
+	ClusteringMetrics clustering;
+	IncrementalPageRank pRank;
+	vector<float> rank;
+	PageRankReport rankReport;
+	int minDegree, maxDegree;
+	double meanDegree;
+} AnalysisResults;
+
+// the same for a sampled estimate of the path measures
+typedef struct {
+	unsigned long version;
+	shared_ptr<const GraphSnapshot> snapshot;
+	PathEstimate paths;
+} EstimateResults;
+
 class GraphWidget : public QGLWidget 
  {
 
@@ -69,7 +99,8 @@ class GraphWidget : public QGLWidget
 	void makeEmpty(int num);	
 	void makeComplete(int num);
 	void makeBinaryTree(int generations);
-	void addVertex(string name);
+	int addVertex(string name);		// returns the new vertex ID
+	void removeVertex(int index);
 	void removeEdge(int from, int to);
 	void addEdge(int from, int to);
 	int getNumV();
@@ -78,17 +109,46 @@ class GraphWidget : public QGLWidget
 	void setName(int index, string name);
 	int getColor(int index);
 	void setColor (int index, int color);
-	vector<int> getOutNeighborIndexList(int index);
+	void getOutNeighbors(int index, vector<int> &neighbors);
 	int getInDegree(int index);
 	int getOutDegree(int index);
 	int getDegree(int index);
 	bool isValidVID (int index);
+	void getVertexIDs(vector<int> &list);
+	int getVertexIDLimit();
+	double getCompressedBytesPerArc();	// of the packed rows, 0 if they are off
+	// A .bgcsr file stays mapped (see MappedGraph) and is shown and analysed
+	// from there, read-only, until the first edit copies it into the graph;
+	// the rest are .bgx
 	void loadFile(string filename);
 	void saveFile(string filename);
+	// the per-vertex results are -1 for a vertex the last analysis didn't see
 	float getAvgShortestPath(int index);
 	float getPageRank(int index);
 	float getCCentrality(int index);
+	float getEccentricity(int index);
+	float getGraphAvgShortestPath();	// -1 if disconnected
+	float getDiameter();
+	vector<long long> getDistanceHistogram();	// ordered pairs by distance
+	void getDegreeStats(int &minDegree, int &maxDegree, double &meanDegree);	// out-degrees
+	PageRankReport getPageRankReport();	// of the last full run
+	int getPageRankPushes();	// by the last incremental update, -1 if it was run in full
 	float getClusteringCoefficient(int index);
+	float getTransitivity();
+	float getAvgClusteringCoefficient();
+	long long getNumTriangles();
+	void getRelatedVertices(int index, int k, vector<pair<int,float> > &related);	// see NiceGraph
+	bool analysisIsRunning();
+	bool analysisIsStale();		// the graph has changed since the last analysis started
+	void estimatePaths(int pivots, float targetError = 0);	// in the background, see NiceGraph::estimatePathMetrics()
+	bool estimateIsRunning();
+	int getEstimatePivots();
+	float getEstimatedAvgShortestPath(float &error);
+	float getEstimatedCCentrality(int index, float &error);	// error -1 if there is no estimate
+	bool canUndo();
+	bool canRedo();
+	unsigned long getJournalHead();
+	bool getChangesSince(unsigned long cursor, vector<GraphChange> &changes);	// false means rebuild, see GraphJournal
 	pair<float,float> getXRange();
 	pair<float,float> getYRange();
 	pair<float,float> getZRange();
@@ -120,7 +180,11 @@ class GraphWidget : public QGLWidget
 	void setDefaultPlot();
 	void panToVertex(int index);
 	void makeUndirected();
+	void reorder(int strategy);		// storage order for the analyses, see NiceGraph::reorder()
+	void setCompressedRows(bool on);	// see NiceGraph::setCompressedRows()
 	void updateAnalysis();
+	void undo();
+	void redo();
 	
 
  signals:
@@ -128,6 +192,8 @@ class GraphWidget : public QGLWidget
 	void yRotationChanged(int angle);
 	void zRotationChanged(int angle);
 	void graphChanged();
+	void analysisFinished();
+	void estimateFinished();
 	void plottingAreaUpdated();
 
  protected:
@@ -143,10 +209,19 @@ class GraphWidget : public QGLWidget
      	void normalizeAngle(int *angle);
 	bool showAxes;
 	void paintGraph();
+	void paintMappedGraph();
 	void resetCamera();
 	void drawSphere(float radius, float x, float y, float z);
 	void drawArrow(float x, float y, float z, vector<float> n);
 	NiceGraph *g;
+	bool compressedRows;
+	void replaceGraph();
+	shared_ptr<const MappedGraph> mapped;	// the graph while a .bgcsr file is only being looked at
+	string mappedFile;
+	vector<int> mappedIndex;	// vertex ID --> dense index in mapped, -1 for none
+	int mappedVertex(int index);	// -1 unless mapped has that vertex
+	void copyMapped();		// before any edit
+	static bool isMappedFile(const string &filename);
 	bool is3D, selfOrganize;
 	void initializeColors();
 	QTimer *selfOrganizeTimer;
@@ -154,9 +229,23 @@ class GraphWidget : public QGLWidget
 	float nodeRadius, autoRepulsion, xMin, xMax, yMin, yMax, zMin, zMax;
 	vector<int> edgeIndexList;
 	vector<int> vertexIndexList;
-	map<int,float>shortestPaths;
-	map<int,float>pRank;
-	map<int,float>cCentrality;
+	unsigned long indexCursor;		// journal position the index lists are up to date with
+	AnalysisResults analysis;
+	unsigned long analysisStarted;	// the version the last job was started on, 0 once the graph is replaced
+	QFutureWatcher<AnalysisResults> *analysisWatcher;
+	bool analysisQueued;
+	static AnalysisResults runAnalysis(shared_ptr<const GraphSnapshot> snapshot, unsigned long version,
+		unsigned long cursor, bool runPageRank);
+	static AnalysisResults runMappedAnalysis(shared_ptr<const MappedGraph> mapped, unsigned long version);
+	IncrementalPageRank pageRank;	// by vertex ID, kept up to date from the journal
+	PageRankReport rankReport;
+	int rankPushes;
+	int analysisIndex(int index);	// dense index in the analysis, -1 if it has no such vertex
+	int snapshotIndex(const GraphSnapshot &snapshot, int index);	// -1 as well if the ID is another vertex's now
+	EstimateResults estimate;
+	unsigned long estimateStarted;
+	QFutureWatcher<EstimateResults> *estimateWatcher;
+	static EstimateResults runEstimate(shared_ptr<const GraphSnapshot> snapshot, unsigned long version, int pivots, float targetError);
 
 
 	int currentVertex, highlightV;
@@ -176,6 +265,8 @@ class GraphWidget : public QGLWidget
 
 private slots:
 	void updateGraphIndices();
+	void collectAnalysis();
+	void collectEstimate();
  };
 
  #endif
@@ -0,0 +1,139 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE:  IDBitset.hpp
+*  	DESCRIPTION:  Fixed size set of vertex or edge IDs, one bit per ID
+*	URL: http://www.babelgraph.org/
+*/
+
+#ifndef IDBITSET_HPP_
+#define IDBITSET_HPP_
+
+#include<vector>
+
+using namespace std;
+
+// An IDBitset holds one bit for each ID below size(), packed 64 to a word so
+// sets can be combined a word at a time.  Bits past size() in the last word
+// are always kept clear, so count() and the word-wise operators never see
+// them.
+
+class IDBitset {
+
+	public:
+	typedef unsigned long long Word;
+	enum {WORD_BITS = 64};
+
+	IDBitset(int numIDs = 0) { resize(numIDs); }
+
+	// grows or shrinks the set, new IDs start out clear
+	void resize(int numIDs)
+	{
+		bits = numIDs;
+		words.resize((numIDs + WORD_BITS - 1) / WORD_BITS, 0);
+		trim();
+	}
+
+	int size() const { return bits; }
+	int numWords() const { return words.size(); }
+
+	bool test(int id) const { return (id >= 0) && (id < bits) && ((words[id / WORD_BITS] >> (id % WORD_BITS)) & 1); }
+	void set(int id) { words[id / WORD_BITS] |= (Word) 1 << (id % WORD_BITS); }
+	void reset(int id) { words[id / WORD_BITS] &= ~((Word) 1 << (id % WORD_BITS)); }
+	void clear() { words.assign(words.size(), 0); }
+
+	int count() const
+	{
+		int total = 0;
+		for (unsigned int w = 0; w < words.size(); w++)
+			total += popcount(words[w]);
+		return total;
+	}
+
+	// the set IDs in increasing order
+	void toList(vector<int> &list) const
+	{
+		list.clear();
+		for (unsigned int w = 0; w < words.size(); w++)
+		{
+			Word word = words[w];
+			while (word)
+			{
+				list.push_back(w * WORD_BITS + lowestBit(word));
+				word &= word - 1;
+			}
+		}
+	}
+
+	// set operations, the other set is treated as clear past its size()
+	IDBitset & operator&=(const IDBitset &other)
+	{
+		for (unsigned int w = 0; w < words.size(); w++)
+			words[w] &= (w < other.words.size()) ? other.words[w] : 0;
+		return *this;
+	}
+	IDBitset & operator|=(const IDBitset &other)
+	{
+		for (unsigned int w = 0; (w < words.size()) && (w < other.words.size()); w++)
+			words[w] |= other.words[w];
+		trim();
+		return *this;
+	}
+	void flip()
+	{
+		for (unsigned int w = 0; w < words.size(); w++)
+			words[w] = ~words[w];
+		trim();
+	}
+
+	// raw words for code that fills the set in bulk; call trim() afterwards
+	// if the last word may have picked up bits past size()
+	Word * data() { return words.empty() ? NULL : &words[0]; }
+	const Word * data() const { return words.empty() ? NULL : &words[0]; }
+	void trim()
+	{
+		if (bits % WORD_BITS)
+			words.back() &= ((Word) 1 << (bits % WORD_BITS)) - 1;
+	}
+
+	static int popcount(Word w)
+	{
+	#ifdef __GNUC__
+		return __builtin_popcountll(w);
+	#else
+		int c = 0;
+		for (; w; c++)
+			w &= w - 1;
+		return c;
+	#endif
+	}
+
+	// index of the lowest set bit, w must not be 0
+	static int lowestBit(Word w)
+	{
+	#ifdef __GNUC__
+		return __builtin_ctzll(w);
+	#else
+		int b = 0;
+		while (!(w & 1)) { w >>= 1; b++; }
+		return b;
+	#endif
+	}
+
+	private:
+	vector<Word> words;
+	int bits;
+};
+
+#endif // IDBITSET_HPP_
@@ -0,0 +1,362 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE: IncrementalPageRank.cpp
+*  	DESCRIPTION: Implementation of PageRank kept up to date across edits
+*	URL: http://www.babelgraph.org/
+*/
+
+
+#include "IncrementalPageRank.hpp"
+#include "GraphSnapshot.hpp"
+#include "NiceGraph.hpp"
+
+#include<cmath>
+
+//------------------------------------------------------------------------------
+IncrementalPageRank::IncrementalPageRank(float d, double tol)
+{
+	damping = d;
+	tolerance = tol;
+	valid = false;
+	cursor = 0;
+	total = 0;
+	count = pushes = 0;
+}
+//------------------------------------------------------------------------------
+void IncrementalPageRank::reset(shared_ptr<const GraphSnapshot> g, const vector<float> &rank, unsigned long at)
+{
+	int n = g->getNumVertices();
+	base = g;
+	cursor = at;
+	valid = true;
+	pushes = 0;
+	count = n;
+
+	moved.clear();
+	addedIDs.clear();
+	rows.clear();
+	edited.clear();
+
+	// scale the ranks up to the unnormalized solution: sum(y) is
+	// n / (1 - d + d * the rank held by vertices with no out edges)
+	double dangling = 0;
+	for (int v = 0; v < n; v++)
+		if (g->getOutDegree(v) == 0)
+			dangling += rank[v];
+	double scale = (n > 0) ? n / (1 - damping + damping * dangling) : 0;
+
+	value.resize(n);
+	degree.resize(n);
+	total = 0;
+	for (int v = 0; v < n; v++)
+	{
+		value[v] = scale * rank[v];
+		degree[v] = g->getOutDegree(v);
+		total += value[v];
+	}
+
+	residual.assign(n, 0);
+	present.assign(n, 1);
+	hasRow.assign(n, 0);
+	listed.assign(n, 0);
+	queued.assign(n, 0);
+	active.clear();
+	queue.clear();
+}
+//------------------------------------------------------------------------------
+bool IncrementalPageRank::update(NiceGraph &g)
+{
+	pushes = 0;
+	if (!valid)
+		return false;
+
+	vector<GraphChange> changes;
+	valid = g.getJournal().getChangesSince(cursor, changes);
+
+	// an undirected edge is an arc each way
+	bool undirected = !g.checkDirected();
+
+	for (unsigned int c = 0; valid && (c < changes.size()); c++)
+	{
+		const GraphChange &change = changes[c];
+		int from = slotOf(change.from), to = slotOf(change.to);
+		switch (change.kind)
+		{
+			case GraphChange::VERTEX_ADDED:
+				addVertex(change.id);
+			break;
+
+			case GraphChange::VERTEX_REMOVED:
+				valid = removeVertex(change.id);
+			break;
+
+			case GraphChange::EDGE_ADDED:
+				valid = addArc(from, to);
+				if (valid && undirected)
+					valid = addArc(to, from);
+			break;
+
+			case GraphChange::EDGE_REMOVED:
+				valid = removeArc(from, to);
+				if (valid && undirected)
+					valid = removeArc(to, from);
+			break;
+
+			case GraphChange::MADE_UNDIRECTED:
+			case GraphChange::MADE_DIRECTED:
+				valid = false;
+			break;
+
+			default:		// names, colors and attributes don't matter here
+			break;
+		}
+	}
+
+	if (!valid)
+		return false;
+
+	// the edited vertices' rows as they stand now
+	for (unsigned int e = 0; e < edited.size(); e++)
+	{
+		int v = edited[e];
+		vector<int> &row = rows[v];
+		row.clear();
+		if (present[v])
+		{
+			NeighborRange outs = g.getOutNeighbors(idOf(v));
+			for (NeighborRange::iterator w = outs.begin(); w != outs.end(); ++w)
+				row.push_back(slotOf(*w));
+		}
+		hasRow[v] = 1;
+	}
+	edited.clear();
+
+	cursor = g.getJournal().getHead();
+	valid = settle();
+	return valid;
+}
+//------------------------------------------------------------------------------
+int IncrementalPageRank::slotOf(int vertexID) const
+{
+	map<int,int>::const_iterator m = moved.find(vertexID);
+	if (m != moved.end())
+		return m->second;
+	return base->getDenseIndex(vertexID);
+}
+//------------------------------------------------------------------------------
+int IncrementalPageRank::idOf(int slot) const
+{
+	int n = base->getNumVertices();
+	return (slot < n) ? base->getVID(slot) : addedIDs[slot - n];
+}
+//------------------------------------------------------------------------------
+void IncrementalPageRank::addVertex(int vertexID)
+{
+	// always a new slot, the ID may be an old one's
+	int v = value.size();
+	moved[vertexID] = v;
+	addedIDs.push_back(vertexID);
+
+	// y = 0 with nothing coming in leaves a residual of 1
+	value.push_back(0);
+	residual.push_back(0);
+	degree.push_back(0);
+	present.push_back(1);
+	hasRow.push_back(0);
+	listed.push_back(0);
+	queued.push_back(0);
+	count++;
+	addResidual(v, 1);
+	edited.push_back(v);
+}
+//------------------------------------------------------------------------------
+bool IncrementalPageRank::removeVertex(int vertexID)
+{
+	// its edges come out of the journal as removals before it does
+	int v = slotOf(vertexID);
+	if ((v < 0) || (degree[v] != 0))
+		return false;
+
+	moved[vertexID] = -1;
+	total -= value[v];
+	value[v] = residual[v] = 0;
+	present[v] = 0;
+	count--;
+	return true;
+}
+//------------------------------------------------------------------------------
+bool IncrementalPageRank::addArc(int from, int to)
+{
+	if ((from < 0) || (to < 0))
+		return false;
+
+	// from now splits its value k+1 ways instead of k; scaling its value by
+	// (k+1)/k keeps what its other neighbors get the same, and the extra is
+	// taken back out of its residual so nothing else changes
+	int k = degree[from];
+	double old = value[from];
+	if (k > 0)
+	{
+		value[from] = old * (k + 1) / k;
+		total += value[from] - old;
+		addResidual(from, old - value[from]);
+		addResidual(to, damping * old / k);
+	}
+	else
+		addResidual(to, damping * old);		// it used to keep it all
+	degree[from] = k + 1;
+	edited.push_back(from);
+	return true;
+}
+//------------------------------------------------------------------------------
+bool IncrementalPageRank::removeArc(int from, int to)
+{
+	if ((from < 0) || (to < 0) || (degree[from] < 1))
+		return false;
+
+	int k = degree[from];
+	double old = value[from];
+	if (k > 1)
+	{
+		value[from] = old * (k - 1) / k;
+		total += value[from] - old;
+		addResidual(from, old - value[from]);
+		addResidual(to, -damping * old / k);
+	}
+	else
+		addResidual(to, -damping * old);
+	degree[from] = k - 1;
+	edited.push_back(from);
+	return true;
+}
+//------------------------------------------------------------------------------
+void IncrementalPageRank::addResidual(int v, double amount)
+{
+	residual[v] += amount;
+	if (!listed[v])
+	{
+		listed[v] = 1;
+		active.push_back(v);
+	}
+}
+//------------------------------------------------------------------------------
+bool IncrementalPageRank::settle()
+{
+	double budget = tolerance * (1 - damping) * total / 2;
+
+	double threshold = -1;
+	while (true)
+	{
+		// drop the slots that have nothing left and total up the rest
+		double outstanding = 0, largest = 0;
+		unsigned int kept = 0;
+		for (unsigned int a = 0; a < active.size(); a++)
+		{
+			int v = active[a];
+			double r = present[v] ? fabs(residual[v]) : 0;
+			if (r == 0)
+			{
+				listed[v] = 0;
+				residual[v] = 0;
+				continue;
+			}
+			active[kept++] = v;
+			outstanding += r;
+			largest = max(largest, r);
+		}
+		active.resize(kept);
+
+		if (outstanding <= budget)
+			break;
+
+		// each round pushes everything over the bar, and what it spills over
+		// it, in the order they got there
+		threshold = (threshold < 0) ? largest / 2 : min(threshold, largest) / 2;
+		for (unsigned int a = 0; a < active.size(); a++)
+			if (fabs(residual[active[a]]) > threshold)
+			{
+				queued[active[a]] = 1;
+				queue.push_back(active[a]);
+			}
+
+		for (unsigned int head = 0; head < queue.size(); head++)
+		{
+			int v = queue[head];
+			queued[v] = 0;
+
+			double r = residual[v];
+			if (fabs(r) <= threshold)
+				continue;
+
+			// spread that far, a full run is cheaper
+			if (++pushes > count)
+			{
+				queue.clear();
+				return false;
+			}
+
+			value[v] += r;
+			total += r;
+			residual[v] = 0;
+
+			// a vertex with no out edges just loses it
+			if (degree[v] == 0)
+				continue;
+
+			double share = damping * r / degree[v];
+			const int *w = base->outBegin(v), *end = base->outEnd(v);
+			if (hasRow[v])
+			{
+				const vector<int> &row = rows[v];
+				w = &row[0];
+				end = w + row.size();
+			}
+			for (; w != end; w++)
+			{
+				addResidual(*w, share);
+				if (!queued[*w] && (fabs(residual[*w]) > threshold))
+				{
+					queued[*w] = 1;
+					queue.push_back(*w);
+				}
+			}
+		}
+		queue.clear();
+	}
+	return true;
+}
+//------------------------------------------------------------------------------
+bool IncrementalPageRank::isValid() const
+{
+	return valid;
+}
+//------------------------------------------------------------------------------
+float IncrementalPageRank::getRank(int vertexID) const
+{
+	int v = base ? slotOf(vertexID) : -1;
+	if ((v < 0) || (total <= 0))
+		return 0;
+	return value[v] / total;
+}
+//------------------------------------------------------------------------------
+int IncrementalPageRank::getPushes() const
+{
+	return pushes;
+}
+//------------------------------------------------------------------------------
+unsigned long IncrementalPageRank::getCursor() const
+{
+	return cursor;
+}
@@ -0,0 +1,112 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE:  IncrementalPageRank.hpp
+*  	DESCRIPTION:  Header file for PageRank kept up to date across edits
+*	URL: http://www.babelgraph.org/
+*/
+
+#ifndef INCREMENTALPAGERANK_HPP_
+#define INCREMENTALPAGERANK_HPP_
+
+#include<vector>
+#include<map>
+#include<memory>
+
+using namespace std;
+
+class GraphSnapshot;
+class NiceGraph;
+
+// An IncrementalPageRank keeps the PageRank of a graph alive across edits,
+// so a few added or removed edges cost a little local work instead of a
+// whole new run.
+//
+// It holds the ranks unnormalized, as the solution y of y = 1 + d A y
+// (A spreads each vertex's value evenly over its out edges, and a vertex
+// with none just loses it); the ranks are y / sum(y), which is exactly what
+// GraphKernels::pageRank() converges to.  reset() scales a full run up to
+// that and takes it as exact.  After that each vertex keeps a residual,
+// what an edit has changed in 1 + d A y - y: adding or removing an edge
+// only changes the residuals at its two ends.  A push moves a vertex's
+// residual into its y and passes d of it on evenly to its out neighbors.
+//
+// update() pushes until the residuals left over add up to no more than
+// tolerance (1-d) sum(y) / 2, which keeps the ranks within tolerance (L1)
+// of what a full run would give.  It pushes the biggest residuals first,
+// halving the bar each round, so a small edit on a big graph is usually
+// settled by a few pushes around the edge.  On a graph where every vertex
+// is a few steps from every other the change can spread everywhere, though;
+// once there have been more pushes than vertices it gives up (update()
+// returns false) and leaves it to a full run.
+//
+// update() reads the edits from the graph's journal, starting from the
+// cursor given to reset(); if the journal no longer reaches back that far
+// or the graph changed directedness, it also returns false.  After a false
+// it has to be reset() from a full run again.
+//
+// The pushes walk the rows of the snapshot the full run was done on, which
+// is kept for that; only the vertices whose out edges have been edited
+// since get a row of their own, copied from the graph.
+
+class IncrementalPageRank {
+
+	public:
+	IncrementalPageRank(float d = 0.85f, double tol = 1e-6);
+
+	// rank is the result of GraphKernels::pageRank() (or GraphSnapshot::pageRank())
+	// with the same damping; at is the journal head when the snapshot was taken
+	void reset(shared_ptr<const GraphSnapshot> g, const vector<float> &rank, unsigned long at);
+	bool update(NiceGraph &g);
+	bool isValid() const;
+
+	float getRank(int vertexID) const;		// 0 for IDs it doesn't know; after a false, the last ranks it had
+	int getPushes() const;					// done by the last update()
+	unsigned long getCursor() const;
+
+	private:
+	float damping;
+	double tolerance;
+	bool valid;
+	unsigned long cursor;
+
+	// everything is kept by slot: the dense index in the snapshot for the
+	// vertices it has, and the next one up for each vertex added since
+	shared_ptr<const GraphSnapshot> base;
+	map<int,int> moved;				// vertex ID --> slot where that isn't the dense index (-1 once removed)
+	vector<int> addedIDs;			// vertex ID of each slot past the snapshot's
+	map<int, vector<int> > rows;	// out neighbors (slots) of the vertices edited since
+	vector<int> edited;				// the slots whose row needs copying again
+
+	vector<double> value, residual;
+	vector<int> degree;
+	vector<char> present, hasRow, listed, queued;
+	vector<int> active;		// every slot that may hold a residual
+	vector<int> queue;
+	double total;			// sum of value
+	int count;				// vertices present
+	int pushes;
+
+	int slotOf(int vertexID) const;
+	int idOf(int slot) const;
+	void addVertex(int vertexID);
+	bool removeVertex(int vertexID);
+	bool addArc(int from, int to);
+	bool removeArc(int from, int to);
+	void addResidual(int v, double amount);
+	bool settle();
+
+};
+
+#endif // INCREMENTALPAGERANK_HPP_
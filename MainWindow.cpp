@@ -26,6 +26,7 @@ MainWindow::MainWindow()
 {
 	setupUi(this);
 	
+	browserCursor = 0;
 	makeDialogs(this);
 
 	makeConnections();
@@ -44,6 +45,7 @@ void MainWindow::makeConnections()
 	QObject::connect(zoomOutButton, SIGNAL (clicked() ), graphWidget, SLOT (zoomOut() ));
 	QObject::connect(addVertexButton, SIGNAL (clicked() ), this, SLOT (addVertex() ));
 	QObject::connect(addEdgeButton, SIGNAL (clicked() ), this, SLOT (addEdge() ));
+	QObject::connect(removeVertexButton, SIGNAL (clicked() ), this, SLOT (removeVertex() ));
 	
 	// window menu related signals
 	QObject::connect(actionNew_Graph, SIGNAL ( triggered() ), this, SLOT( newGraph() ));
@@ -66,6 +68,12 @@ void MainWindow::makeConnections()
 	QObject::connect(actionAbout_BabelGraph, SIGNAL ( triggered() ), this, SLOT (showAboutWindow() ));
 	QObject::connect(actionExport_Image, SIGNAL (triggered() ), this, SLOT (exportImagePNG() ));
 	QObject::connect(actionMake_Undirected, SIGNAL (triggered() ), graphWidget, SLOT( makeUndirected()   ));
+	QObject::connect(actionUndo, SIGNAL(triggered() ), graphWidget, SLOT(undo()));
+	QObject::connect(actionRedo, SIGNAL(triggered() ), graphWidget, SLOT(redo()));
+	QObject::connect(actionEstimate_Sample, SIGNAL(triggered() ), this, SLOT(estimatePathsBySample()));
+	QObject::connect(actionEstimate_Error, SIGNAL(triggered() ), this, SLOT(estimatePathsToError()));
+	QObject::connect(actionStorage_Order, SIGNAL(triggered() ), this, SLOT(chooseStorageOrder()));
+	QObject::connect(actionCompressed_Rows, SIGNAL(toggled(bool) ), this, SLOT(setCompressedRows(bool)));
 	QObject::connect(actionSave_Graph, SIGNAL(triggered() ), this, SLOT(saveGraph()));
 	QObject::connect(actionLoad_Graph, SIGNAL(triggered() ), this, SLOT(loadGraph()));
 	QObject::connect(actionBabelGraph_Help, SIGNAL(triggered() ), this, SLOT(showHelp()));
@@ -95,15 +103,28 @@ void MainWindow::makeConnections()
 	QObject::connect(comboBox_ColorSelect, SIGNAL(currentIndexChanged(int)), this, SLOT(updateVertexColor(int)));
 	QObject::connect(addNeighborButton, SIGNAL(clicked()), this, SLOT(addNeighbor()));
 	QObject::connect(removeNeighborButton, SIGNAL(clicked()), this, SLOT(removeNeighbor()));
+	QObject::connect(listWidget_Related, SIGNAL(itemActivated(QListWidgetItem*)), this, SLOT(selectRelatedVertex(QListWidgetItem*)));
 	QObject::connect(pushButton_Update_Analysis, SIGNAL(clicked()), this, SLOT(updateAnalysis()));
 
 	// GraphWidget Signals
 	QObject::connect(graphWidget, SIGNAL(graphChanged()), this, SLOT(makeVertexBrowserList()));
+	QObject::connect(graphWidget, SIGNAL(analysisFinished()), this, SLOT(analysisFinished()));
+	QObject::connect(graphWidget, SIGNAL(estimateFinished()), this, SLOT(estimateFinished()));
+}
+
+int MainWindow::currentVertexID()
+{
+	// the browser rows hold the vertex IDs as item data, since removed
+	// vertices leave gaps in the IDs
+	int row = vertexSelectorComboBox->currentIndex();
+	if (row < 0)
+		return -1;
+	return vertexSelectorComboBox->itemData(row, Qt::UserRole).toInt();
 }
 
 void MainWindow::highlightVertex()
 {
-	int index = vertexSelectorComboBox->currentIndex();
+	int index = currentVertexID();
 
 	if (graphWidget->isValidVID(index))
 	{
@@ -129,12 +150,113 @@ void MainWindow::showHelp()
 }
 void MainWindow::updateAnalysis()
 {
+	// the results come back through analysisFinished()
 	graphWidget->updateAnalysis();
 
-	makeVertexBrowserList();
-
 	pushButton_Update_Analysis->setEnabled(false);
 }
+void MainWindow::analysisFinished()
+{
+	loadVertexData(vertexSelectorComboBox->currentIndex());
+
+	// the whole graph figures don't fit in the form, so they go in a tooltip
+	QString summary = QString("Average shortest path: %1\nDiameter: %2\nPairs by distance:")
+		.arg(graphWidget->getGraphAvgShortestPath()).arg(graphWidget->getDiameter());
+	vector<long long> histogram = graphWidget->getDistanceHistogram();
+	for (unsigned int d = 0; d < histogram.size(); d++)
+		if (histogram[d] > 0)
+			summary += QString("\n  %1: %2").arg(d).arg(histogram[d]);
+	int minDegree, maxDegree;
+	double meanDegree;
+	graphWidget->getDegreeStats(minDegree, maxDegree, meanDegree);
+	summary += QString("\nOut-degree: %1 to %2, mean %3").arg(minDegree).arg(maxDegree).arg(meanDegree);
+	summary += QString("\nTriangles: %1\nTransitivity: %2\nAverage clustering coefficient: %3")
+		.arg(graphWidget->getNumTriangles()).arg(graphWidget->getTransitivity()).arg(graphWidget->getAvgClusteringCoefficient());
+	PageRankReport rank = graphWidget->getPageRankReport();
+	if (graphWidget->getPageRankPushes() >= 0)
+		summary += QString("\nPage Rank: updated for the edits with %1 pushes").arg(graphWidget->getPageRankPushes());
+	else
+		summary += QString("\nPage Rank: %1 iterations, residual %2%3").arg(rank.iterations).arg(rank.residual)
+			.arg(rank.converged ? "" : " (not converged)");
+	groupBox_Analysis->setToolTip(summary);
+
+	// the graph may have been edited while the analysis was running
+	pushButton_Update_Analysis->setEnabled(graphWidget->analysisIsStale() && !graphWidget->analysisIsRunning());
+}
+void MainWindow::estimatePathsBySample()
+{
+	bool ok;
+
+	QString title = "Estimate path lengths";
+	QString message = "Number of vertices to search from";
+
+	int pivots = QInputDialog::getInteger(this, title, message, 256, 1, qMax(1, graphWidget->getNumV()), 1, &ok);
+	if (ok)
+	{
+		actionEstimate_Sample->setEnabled(false);
+		actionEstimate_Error->setEnabled(false);
+		graphWidget->estimatePaths(pivots);
+	}
+}
+void MainWindow::estimatePathsToError()
+{
+	bool ok;
+
+	QString title = "Estimate path lengths";
+	QString message = "Target error (% of the value, 95% confidence)";
+
+	double percent = QInputDialog::getDouble(this, title, message, 5.0, 0.1, 50.0, 1, &ok);
+	if (ok)
+	{
+		actionEstimate_Sample->setEnabled(false);
+		actionEstimate_Error->setEnabled(false);
+		graphWidget->estimatePaths(0, percent / 100.0);
+	}
+}
+void MainWindow::chooseStorageOrder()
+{
+	bool ok;
+
+	QString title = "Storage order";
+	QString message = "Lay the vertices out for the analyses in";
+
+	// in the order of NiceGraph::ORDERINGS
+	QStringList orders;
+	orders << "ID order" << "Reverse Cuthill-McKee" << "Degree order" << "Gorder";
+
+	QString order = QInputDialog::getItem(this, title, message, orders, 0, false, &ok);
+	if (ok)
+		graphWidget->reorder(orders.indexOf(order));
+}
+void MainWindow::setCompressedRows(bool on)
+{
+	graphWidget->setCompressedRows(on);
+	if (on)
+		QMessageBox::information(this, "Compressed rows",
+			QString("BFS, PageRank and triangle counts now read rows of %1 bytes per arc")
+			.arg(graphWidget->getCompressedBytesPerArc(), 0, 'f', 2));
+}
+void MainWindow::estimateFinished()
+{
+	actionEstimate_Sample->setEnabled(true);
+	actionEstimate_Error->setEnabled(true);
+
+	float error;
+	float path = graphWidget->getEstimatedAvgShortestPath(error);
+	QString info = QString("Searched from %1 vertices<br>").arg(graphWidget->getEstimatePivots());
+	if (path < 0)
+		info += "Average shortest path: -1 (the graph is disconnected)<br>";
+	else
+		info += QString("Average shortest path: %1 &plusmn; %2<br>").arg(path).arg(error);
+
+	int index = currentVertexID();
+	float closeness = graphWidget->getEstimatedCCentrality(index, error);
+	if (error >= 0)
+		info += QString("Closeness centrality of %1: %2 &plusmn; %3")
+			.arg(QString::fromStdString(graphWidget->getName(index))).arg(closeness).arg(error);
+
+	QMessageBox::information(this, "Estimated path lengths", info);
+}
 
 void MainWindow::saveGraph()
 {
@@ -142,7 +264,7 @@ void MainWindow::saveGraph()
 	QString fileName = QFileDialog::getSaveFileName(this,
                                  title,
 				"new_graph.bgx",
-                                 "BabelGraph Files (*.bgx);;All Files (*)");
+                                 "BabelGraph Files (*.bgx);;BabelGraph CSR Files, structure only (*.bgcsr);;All Files (*)");
 	graphWidget->saveFile(fileName.toStdString());
 }
 
@@ -152,7 +274,7 @@ void MainWindow::loadGraph()
   	QString fileName = QFileDialog::getOpenFileName(this,
                                  title,
                                  " ",
-                                 "BabelGraph Files (*.bgx);;All Files (*)");
+                                 "BabelGraph Files (*.bgx);;BabelGraph CSR Files (*.bgcsr);;All Files (*)");
 
 	graphWidget->loadFile(fileName.toStdString());
 
@@ -210,7 +332,8 @@ void MainWindow::makeStyleWindows()
 void MainWindow::removeNeighbor()
 {
 
-	int from = vertexSelectorComboBox->currentIndex();
+	int row = vertexSelectorComboBox->currentIndex();
+	int from = currentVertexID();
 	int index = comboBox_RemoveNodeList->currentIndex();
 	QVariant to_value = comboBox_RemoveNodeList->itemData(index, Qt::UserRole);
 	int to = to_value.toInt();
@@ -218,13 +341,14 @@ void MainWindow::removeNeighbor()
 	if ((from >= 0) && (to >= 0))
 		graphWidget->removeEdge(from,to);
 
-	vertexSelectorComboBox->setCurrentIndex(from);
+	vertexSelectorComboBox->setCurrentIndex(row);
 
 }
 
 void MainWindow::addNeighbor()
 {
-	int from = vertexSelectorComboBox->currentIndex();
+	int row = vertexSelectorComboBox->currentIndex();
+	int from = currentVertexID();
 	int index = comboBox_AddNodeList->currentIndex();
 	QVariant to_value = comboBox_AddNodeList->itemData(index, Qt::UserRole);
 	int to = to_value.toInt();
@@ -232,12 +356,12 @@ void MainWindow::addNeighbor()
 	if ((from >= 0) && (to >= 0))
 		graphWidget->addEdge(from,to);
 
-	vertexSelectorComboBox->setCurrentIndex(from);
+	vertexSelectorComboBox->setCurrentIndex(row);
 }
 
 void MainWindow::updateVertexColor(int newColor)
 {
-	int index = vertexSelectorComboBox->currentIndex();
+	int index = currentVertexID();
 
 	if ((index >= 0) && (newColor >= 0))
 		graphWidget->setColor(index,newColor);
@@ -246,34 +370,127 @@ void MainWindow::makeVertexBrowserList()
 {
 	// any time there is a change, be sure to allow for update analysis
 	pushButton_Update_Analysis->setEnabled(true);
-	
-	vertexSelectorComboBox->clear();	// clears all entries to make it again from scratch
+	actionUndo->setEnabled(graphWidget->canUndo());
+	actionRedo->setEnabled(graphWidget->canRedo());
 
-	QString entry = "";
-	
-	for (int i = 0; i < graphWidget->getNumV(); i++)
+	// apply just what changed since the list was last made, unless the
+	// journal can't say (eg. a new graph), then make it again from scratch
+	vector<GraphChange> changes;
+	bool incremental = graphWidget->getChangesSince(browserCursor, changes);
+	browserCursor = graphWidget->getJournalHead();
+
+	if (!incremental)
 	{
-		entry = QString("(%1)") .arg (i,0,10);
+		vertexSelectorComboBox->clear();
 
-		QString name = QString::fromStdString(graphWidget->getName(i));
+		vector<int> ids;
+		graphWidget->getVertexIDs(ids);
 
-		entry += " " + name;
+		for (unsigned int v = 0; v < ids.size(); v++)
+			vertexSelectorComboBox->addItem(browserEntry(ids[v]), ids[v]);
+		return;
+	}
 
-		vertexSelectorComboBox->addItem(entry);
+	int current = currentVertexID();
+	bool reload = false;	// the selected vertex's details are out of date
+	for (unsigned int c = 0; c < changes.size(); c++)
+	{
+		int id = changes[c].id;
+		switch (changes[c].kind)
+		{
+			case GraphChange::VERTEX_ADDED:
+			{
+				// the rows are in ID order
+				int row = 0, high = vertexSelectorComboBox->count();
+				while (row < high)
+				{
+					int mid = (row + high) / 2;
+					if (vertexSelectorComboBox->itemData(mid, Qt::UserRole).toInt() < id)
+						row = mid + 1;
+					else
+						high = mid;
+				}
+				vertexSelectorComboBox->insertItem(row, browserEntry(id), id);
+				reload = true;
+				break;
+			}
+			case GraphChange::VERTEX_REMOVED:
+			{
+				int row = vertexSelectorComboBox->findData(id, Qt::UserRole);
+				if (row >= 0)
+					vertexSelectorComboBox->removeItem(row);
+				reload = true;
+				break;
+			}
+			case GraphChange::NAME_CHANGED:
+			{
+				int row = vertexSelectorComboBox->findData(id, Qt::UserRole);
+				if (row >= 0)
+					vertexSelectorComboBox->setItemText(row, browserEntry(id));
+				reload = reload || (id != current);		// it may be in the neighbor lists
+				break;
+			}
+			case GraphChange::COLOR_CHANGED:
+			case GraphChange::VERTEX_ATTRIBUTE_CHANGED:
+			case GraphChange::EDGE_ATTRIBUTE_CHANGED:
+				break;
+			default:		// edges, which change the neighbor lists
+				reload = true;
+		}
+	}
+
+	if (reload)
+		loadVertexData(vertexSelectorComboBox->currentIndex());
+	else if (graphWidget->isValidVID(current))
+	{
+		// eg. an undo of a change to the selected vertex; leave the fields
+		// alone when they already agree, so typing a name isn't disturbed
+		QString name = QString::fromStdString(graphWidget->getName(current));
+		if (lineEdit_NameEdit->text() != name)
+			lineEdit_NameEdit->setText(name);
+		if (comboBox_ColorSelect->currentIndex() != graphWidget->getColor(current))
+			comboBox_ColorSelect->setCurrentIndex(graphWidget->getColor(current));
+	}
+}
+void MainWindow::loadRelatedVertices(int index)
+{
+	// a local personalized PageRank from the selected vertex, fast enough
+	// to redo on every selection
+	listWidget_Related->clear();
+	if (!graphWidget->isValidVID(index))
+		return;
+
+	vector<pair<int,float> > related;
+	graphWidget->getRelatedVertices(index, RELATED_VERTICES, related);
+	for (unsigned int r = 0; r < related.size(); r++)
+	{
+		QListWidgetItem *item = new QListWidgetItem(browserEntry(related[r].first), listWidget_Related);
+		item->setData(Qt::UserRole, related[r].first);
+		item->setToolTip(QString("Personalized PageRank %1").arg(related[r].second));
 	}
 }
+void MainWindow::selectRelatedVertex(QListWidgetItem *item)
+{
+	int row = vertexSelectorComboBox->findData(item->data(Qt::UserRole), Qt::UserRole);
+	if (row >= 0)
+		vertexSelectorComboBox->setCurrentIndex(row);
+}
+QString MainWindow::browserEntry(int id)
+{
+	QString entry = QString("(%1)") .arg (id,0,10);
+	return entry + " " + QString::fromStdString(graphWidget->getName(id));
+}
 void MainWindow::updateVertexName(QString name)
 {
-
-	int index = vertexSelectorComboBox->currentIndex();
-	graphWidget->setName(index, name.toStdString());
-
-	makeVertexBrowserList();
-	vertexSelectorComboBox->setCurrentIndex(index);
-
+	// makeVertexBrowserList() picks the new name up from the journal
+	int index = currentVertexID();
+	if (index >= 0)
+		graphWidget->setName(index, name.toStdString());
 }
-void MainWindow::loadVertexData(int index)
+void MainWindow::loadVertexData(int row)
 {
+	int index = (row < 0) ? -1 : vertexSelectorComboBox->itemData(row, Qt::UserRole).toInt();
+
 	// clear the old stuff
 	lineEdit_NameEdit->setText("");
 
@@ -285,6 +502,8 @@ void MainWindow::loadVertexData(int index)
 	lcdNumber_Degree_in->display(0);
 	lcdNumber_Degree_out->display(0);
 
+	loadRelatedVertices(index);
+
 	// make the new stuff
 	if (graphWidget->isValidVID(index))
 	{
@@ -299,8 +518,12 @@ void MainWindow::loadVertexData(int index)
 		comboBox_ColorSelect->setCurrentIndex(graphWidget->getColor(index));
 	
 
-		// get list of outgoing neighbors
-		vector<int> neighbors = graphWidget->getOutNeighborIndexList( index);
+		// mark the outgoing neighbors
+		vector<bool> isNeighbor(graphWidget->getVertexIDLimit(), false);
+		vector<int> neighbors;
+		graphWidget->getOutNeighbors(index, neighbors);
+		for (unsigned int n = 0; n < neighbors.size(); n++)
+			isNeighbor[neighbors[n]] = true;
 
 		// set size
 		lcdNumber_Degree->display(graphWidget->getDegree(index));
@@ -310,22 +533,22 @@ void MainWindow::loadVertexData(int index)
 		lcdNumber_PageRank->display(graphWidget->getPageRank(index));
 		lcdNumber_ClosenessCentrality->display(graphWidget->getCCentrality(index));
 		lcdNumber_ClusteringCoefficient->display(graphWidget->getClusteringCoefficient(index));
+		lcdNumber_Eccentricity->display(graphWidget->getEccentricity(index));
 	
 		int rCounter = 0, aCounter = 0;
+		vector<int> ids;
+		graphWidget->getVertexIDs(ids);
 
-		for (int i = 0; i < graphWidget->getNumV(); i++)
+		for (unsigned int v = 0; v < ids.size(); v++)
 		{
+			int i = ids[v];
 			QString entry = QString("(%1)") .arg (i,0,10);
 			QString name = QString::fromStdString(graphWidget->getName(i));
 			entry += " " + name;
 
-			// is it already connected or not?
-			vector<int>::iterator iter;
-			iter = std::find(neighbors.begin(), neighbors.end(), i);
-		
 			if (i != index)		// can't connect to self
 			{
-				if (iter != neighbors.end())  // add to remove list, since already neighbor
+				if (isNeighbor[i])  // add to remove list, since already neighbor
 				{
 					comboBox_RemoveNodeList->addItem(entry); 		// found the neighbor!
 					comboBox_RemoveNodeList->setItemData(rCounter, i, Qt::UserRole);
@@ -398,8 +621,8 @@ void MainWindow::addVertex()
 
      if (ok)
 	{
-         	graphWidget->addVertex( text.toStdString() );
-		vertexSelectorComboBox->setCurrentIndex((int)graphWidget->getNumV() - 1);
+         	int id = graphWidget->addVertex( text.toStdString() );
+		vertexSelectorComboBox->setCurrentIndex(vertexSelectorComboBox->findData(id, Qt::UserRole));
 
 	}
 }
@@ -413,15 +636,24 @@ void MainWindow::addEdge()
 	QString message2 = "Choose the index of the second vertex";
 
      	int vertex1 = QInputDialog::getInteger(this, title,
-                                      message1, 0, 0, graphWidget->getNumV() - 1, 1, &ok);
+                                      message1, 0, 0, graphWidget->getVertexIDLimit() - 1, 1, &ok);
 
 	int vertex2 = QInputDialog::getInteger(this, title,
-                                      message2, 0, 0, graphWidget->getNumV() - 1, 1, &ok);
+                                      message2, 0, 0, graphWidget->getVertexIDLimit() - 1, 1, &ok);
 
-     if (ok)
+     if (ok && graphWidget->isValidVID(vertex1) && graphWidget->isValidVID(vertex2))
          graphWidget->addEdge( vertex1, vertex2 );
 }
 
+void MainWindow::removeVertex()
+{
+	// removes the vertex selected in the browser, with all its edges
+	int index = currentVertexID();
+
+	if (graphWidget->isValidVID(index))
+		graphWidget->removeVertex(index);
+}
+
 void MainWindow::resetViewDim()
 {
 	if (radioButton_3D->isChecked())
@@ -561,6 +793,21 @@ void MainWindow::setupUi(QMainWindow *MainWindow)
 
     actionMake_Undirected = new QAction(MainWindow);
     actionMake_Undirected->setObjectName(QString::fromUtf8("actionMake_Undirected"));
+    actionUndo = new QAction(MainWindow);
+    actionUndo->setObjectName(QString::fromUtf8("actionUndo"));
+    actionUndo->setEnabled(false);
+    actionRedo = new QAction(MainWindow);
+    actionRedo->setObjectName(QString::fromUtf8("actionRedo"));
+    actionRedo->setEnabled(false);
+    actionEstimate_Sample = new QAction(MainWindow);
+    actionEstimate_Sample->setObjectName(QString::fromUtf8("actionEstimate_Sample"));
+    actionEstimate_Error = new QAction(MainWindow);
+    actionEstimate_Error->setObjectName(QString::fromUtf8("actionEstimate_Error"));
+    actionStorage_Order = new QAction(MainWindow);
+    actionStorage_Order->setObjectName(QString::fromUtf8("actionStorage_Order"));
+    actionCompressed_Rows = new QAction(MainWindow);
+    actionCompressed_Rows->setObjectName(QString::fromUtf8("actionCompressed_Rows"));
+    actionCompressed_Rows->setCheckable(true);
 
     centralwidget = new QWidget(MainWindow);
     centralwidget->setObjectName(QString::fromUtf8("centralwidget"));
@@ -587,6 +834,11 @@ void MainWindow::setupUi(QMainWindow *MainWindow)
 
     top_button_bar->addWidget(addEdgeButton);
 
+    removeVertexButton = new QPushButton(horizontalLayoutWidget_6);
+    removeVertexButton->setObjectName(QString::fromUtf8("removeVertexButton"));
+
+    top_button_bar->addWidget(removeVertexButton);
+
  zoomInButton = new QPushButton(horizontalLayoutWidget_6);
     zoomInButton->setObjectName(QString::fromUtf8("zoomInButton"));
     zoomInButton->setMinimumSize(QSize(0, 28));
@@ -731,10 +983,10 @@ void MainWindow::setupUi(QMainWindow *MainWindow)
 
         groupBox_Analysis = new QGroupBox(tab_browse_edit);
     groupBox_Analysis->setObjectName(QString::fromUtf8("groupBox_Analysis"));
-    groupBox_Analysis->setGeometry(QRect(10, 270, 231, 271));
+    groupBox_Analysis->setGeometry(QRect(10, 270, 231, 305));
     formLayoutWidget_3 = new QWidget(groupBox_Analysis);
     formLayoutWidget_3->setObjectName(QString::fromUtf8("formLayoutWidget_3"));
-    formLayoutWidget_3->setGeometry(QRect(10, 20, 211, 241));
+    formLayoutWidget_3->setGeometry(QRect(10, 20, 211, 275));
     formLayout_3 = new QFormLayout(formLayoutWidget_3);
     formLayout_3->setObjectName(QString::fromUtf8("formLayout_3"));
     formLayout_3->setFieldGrowthPolicy(QFormLayout::AllNonFixedFieldsGrow);
@@ -816,6 +1068,17 @@ void MainWindow::setupUi(QMainWindow *MainWindow)
 
     formLayout_3->setWidget(6, QFormLayout::FieldRole, lcdNumber_ClusteringCoefficient);
 
+    label_Eccentricity = new QLabel(formLayoutWidget_3);
+    label_Eccentricity->setObjectName(QString::fromUtf8("label_Eccentricity"));
+
+    formLayout_3->setWidget(7, QFormLayout::LabelRole, label_Eccentricity);
+
+    lcdNumber_Eccentricity = new QLCDNumber(formLayoutWidget_3);
+    lcdNumber_Eccentricity->setObjectName(QString::fromUtf8("lcdNumber_Eccentricity"));
+	lcdNumber_Eccentricity->setSegmentStyle(QLCDNumber::Flat);
+
+    formLayout_3->setWidget(7, QFormLayout::FieldRole, lcdNumber_Eccentricity);
+
 
     gridLayoutWidget = new QWidget(tab_browse_edit);
     gridLayoutWidget->setObjectName(QString::fromUtf8("gridLayoutWidget"));
@@ -849,7 +1112,7 @@ void MainWindow::setupUi(QMainWindow *MainWindow)
 
     pushButton_Update_Analysis = new QPushButton(tab_browse_edit);
     pushButton_Update_Analysis->setObjectName(QString::fromUtf8("pushButton_Update_Analysis"));
-    pushButton_Update_Analysis->setGeometry(QRect(60, 550, 101, 28));
+    pushButton_Update_Analysis->setGeometry(QRect(60, 585, 101, 28));
     pushButton_Update_Analysis->setMinimumSize(QSize(130,28));	
 pushButton_Update_Analysis->setEnabled(false);
 
@@ -1042,6 +1305,19 @@ pushButton_Update_Analysis->setEnabled(false);
     button_Default_Plot->setMaximumSize(QSize(80, 28));
 
     SideBar->addTab(tab_layout, QString());
+
+    tab_related = new QWidget();
+    tab_related->setObjectName(QString::fromUtf8("tab_related"));
+    tab_related->setGeometry(QRect(0, 0, 246, 622));
+    label_Related = new QLabel(tab_related);
+    label_Related->setObjectName(QString::fromUtf8("label_Related"));
+    label_Related->setGeometry(QRect(10, 10, 231, 40));
+    label_Related->setWordWrap(true);
+    listWidget_Related = new QListWidget(tab_related);
+    listWidget_Related->setObjectName(QString::fromUtf8("listWidget_Related"));
+    listWidget_Related->setGeometry(QRect(10, 55, 231, 250));
+
+    SideBar->addTab(tab_related, QString());
     /*
 	Nothing here yet, so comment out... maybe in the next release...
 	tab_analysis = new QWidget();
@@ -1056,15 +1332,17 @@ pushButton_Update_Analysis->setEnabled(false);
     menuFile->setObjectName(QString::fromUtf8("menuFile"));
     menuHelp = new QMenu(menubar);
     menuHelp->setObjectName(QString::fromUtf8("menuHelp"));
+    menuAnalysis = new QMenu(menubar);
+    menuAnalysis->setObjectName(QString::fromUtf8("menuAnalysis"));
     /*
 	Nothing here yet, so comment out... maybe in the next release...
-	menuAnalysis = new QMenu(menubar);
-    menuAnalysis->setObjectName(QString::fromUtf8("menuAnalysis"));
     menuGraph_Data = new QMenu(menuAnalysis);
     menuGraph_Data->setObjectName(QString::fromUtf8("menuGraph_Data"));
     menuVertex_Data = new QMenu(menuAnalysis);
     menuVertex_Data->setObjectName(QString::fromUtf8("menuVertex_Data"));
 	NB->DONT FORGET TO UNCOMMENT THE MENU ACTIONS BELOW!, and the RETRANSLATE AT THE BOTTOM*/
+    menuEdit = new QMenu(menubar);
+    menuEdit->setObjectName(QString::fromUtf8("menuEdit"));
     menuGraph = new QMenu(menubar);
     menuGraph->setObjectName(QString::fromUtf8("menuGraph"));
     menuGenerate_Graph = new QMenu(menuGraph);
@@ -1078,8 +1356,9 @@ pushButton_Update_Analysis->setEnabled(false);
     MainWindow->setMenuBar(menubar);
 
     menubar->addAction(menuFile->menuAction());
+    menubar->addAction(menuEdit->menuAction());
     menubar->addAction(menuGraph->menuAction());
-    //menubar->addAction(menuAnalysis->menuAction());
+    menubar->addAction(menuAnalysis->menuAction());
 	menubar->addAction(menuView->menuAction());
     menubar->addAction(menuHelp->menuAction());
     menuFile->addAction(actionNew_Graph);
@@ -1094,6 +1373,13 @@ pushButton_Update_Analysis->setEnabled(false);
     //menuFile->addAction(actionPreferences);
     menuFile->addSeparator();
     menuFile->addAction(actionExit);
+    menuEdit->addAction(actionUndo);
+    menuEdit->addAction(actionRedo);
+    menuAnalysis->addAction(actionEstimate_Sample);
+    menuAnalysis->addAction(actionEstimate_Error);
+    menuAnalysis->addSeparator();
+    menuAnalysis->addAction(actionStorage_Order);
+    menuAnalysis->addAction(actionCompressed_Rows);
     menuHelp->addAction(actionBabelGraph_Help);
     menuHelp->addAction(actionAbout_BabelGraph);
     /*menuAnalysis->addAction(menuGraph_Data->menuAction());
@@ -1158,6 +1444,7 @@ pushButton_Update_Analysis->setEnabled(false);
     actionPath_Length->setText(QApplication::translate("MainWindow", "Path Length", 0, QApplication::UnicodeUTF8));
     actionClustering_2->setText(QApplication::translate("MainWindow", "Clustering", 0, QApplication::UnicodeUTF8));
     label_ClusteringCoefficient->setText(QApplication::translate("MainWindow", "Clustering Coefficient", 0, QApplication::UnicodeUTF8));
+    label_Eccentricity->setText(QApplication::translate("MainWindow", "Eccentricity", 0, QApplication::UnicodeUTF8));
     actionDegree_Distribution->setText(QApplication::translate("MainWindow", "Degree Distribution", 0, QApplication::UnicodeUTF8));
     actionEmpty->setText(QApplication::translate("MainWindow", "Empty", 0, QApplication::UnicodeUTF8));
     actionRandom->setText(QApplication::translate("MainWindow", "Random", 0, QApplication::UnicodeUTF8));
@@ -1189,6 +1476,8 @@ pushButton_Update_Analysis->setEnabled(false);
     addVertexButton->setShortcut(QApplication::translate("MainWindow", "Ctrl+V", 0, QApplication::UnicodeUTF8));
     addEdgeButton->setText(QApplication::translate("MainWindow", "Add Edge", 0, QApplication::UnicodeUTF8));
     addEdgeButton->setShortcut(QApplication::translate("MainWindow", "Ctrl+E", 0, QApplication::UnicodeUTF8));
+    removeVertexButton->setText(QApplication::translate("MainWindow", "Remove Vertex", 0, QApplication::UnicodeUTF8));
+    removeVertexButton->setShortcut(QApplication::translate("MainWindow", "Ctrl+D", 0, QApplication::UnicodeUTF8));
 
 #ifndef QT_NO_TOOLTIP
     zoomInButton->setToolTip(QApplication::translate("MainWindow", "Zoom In", 0, QApplication::UnicodeUTF8));
@@ -1261,15 +1550,26 @@ label_AvgShortestPath->setText(QApplication::translate("MainWindow", "Average Sh
 	    button_Replot->setText(QApplication::translate("MainWindow", "Replot", 0, QApplication::UnicodeUTF8));    
 	    button_Default_Plot->setText(QApplication::translate("MainWindow", "Default", 0, QApplication::UnicodeUTF8));
 SideBar->setTabText(SideBar->indexOf(tab_layout), QApplication::translate("MainWindow", "Layout", 0, QApplication::UnicodeUTF8));
+    SideBar->setTabText(SideBar->indexOf(tab_related), QApplication::translate("MainWindow", "Related", 0, QApplication::UnicodeUTF8));
+    label_Related->setText(QApplication::translate("MainWindow", "Vertices most related to the selected one (double click to select)", 0, QApplication::UnicodeUTF8));
     //SideBar->setTabText(SideBar->indexOf(tab_analysis), QApplication::translate("MainWindow", "Analysis", 0, QApplication::UnicodeUTF8));
     menuFile->setTitle(QApplication::translate("MainWindow", "File", 0, QApplication::UnicodeUTF8));
     menuHelp->setTitle(QApplication::translate("MainWindow", "Help", 0, QApplication::UnicodeUTF8));
-    /*menuAnalysis->setTitle(QApplication::translate("MainWindow", "Analysis", 0, QApplication::UnicodeUTF8));
-    menuGraph_Data->setTitle(QApplication::translate("MainWindow", "Graph Data", 0, QApplication::UnicodeUTF8));
+    menuAnalysis->setTitle(QApplication::translate("MainWindow", "Analysis", 0, QApplication::UnicodeUTF8));
+    /*menuGraph_Data->setTitle(QApplication::translate("MainWindow", "Graph Data", 0, QApplication::UnicodeUTF8));
     menuVertex_Data->setTitle(QApplication::translate("MainWindow", "Vertex Data", 0, QApplication::UnicodeUTF8));*/
     menuGraph->setTitle(QApplication::translate("MainWindow", "Graph", 0, QApplication::UnicodeUTF8));
     menuGenerate_Graph->setTitle(QApplication::translate("MainWindow", "Generate Graph", 0, QApplication::UnicodeUTF8));
     actionMake_Undirected->setText(QApplication::translate("MainWindow", "Make Undirected", 0, QApplication::UnicodeUTF8));
+    menuEdit->setTitle(QApplication::translate("MainWindow", "Edit", 0, QApplication::UnicodeUTF8));
+    actionUndo->setText(QApplication::translate("MainWindow", "Undo", 0, QApplication::UnicodeUTF8));
+    actionUndo->setShortcut(QApplication::translate("MainWindow", "Ctrl+Z", 0, QApplication::UnicodeUTF8));
+    actionRedo->setText(QApplication::translate("MainWindow", "Redo", 0, QApplication::UnicodeUTF8));
+    actionRedo->setShortcut(QApplication::translate("MainWindow", "Ctrl+Y", 0, QApplication::UnicodeUTF8));
+    actionEstimate_Sample->setText(QApplication::translate("MainWindow", "Estimate Path Lengths (Sample Size)...", 0, QApplication::UnicodeUTF8));
+    actionEstimate_Error->setText(QApplication::translate("MainWindow", "Estimate Path Lengths (Target Error)...", 0, QApplication::UnicodeUTF8));
+    actionStorage_Order->setText(QApplication::translate("MainWindow", "Storage Order...", 0, QApplication::UnicodeUTF8));
+    actionCompressed_Rows->setText(QApplication::translate("MainWindow", "Compressed Rows", 0, QApplication::UnicodeUTF8));
     menuView->setTitle(QApplication::translate("MainWindow", "View", 0, QApplication::UnicodeUTF8));
     menuSet_Window_Style->setTitle(QApplication::translate("MainWindow", "Set Window Style", 0, QApplication::UnicodeUTF8));
 
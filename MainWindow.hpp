@@ -36,6 +36,7 @@
 #include <QtGui/QLCDNumber>
 #include <QtGui/QLabel>
 #include <QtGui/QLineEdit>
+#include <QtGui/QListWidget>
 #include <QtGui/QMainWindow>
 #include <QtGui/QMenu>
 #include <QtGui/QMenuBar>
@@ -74,6 +75,7 @@ private slots:
 	void showAboutWindow();
 	void showHelp();
 	void addVertex();
+	void removeVertex();
 	void addEdge();
 	void resetViewDim();
 	void replotGraph();
@@ -93,6 +95,13 @@ private slots:
 	void updatePlotValues();
 	void changeBackgroundColor();
 	void updateAnalysis();
+	void analysisFinished();
+	void estimatePathsBySample();
+	void estimatePathsToError();
+	void estimateFinished();
+	void chooseStorageOrder();
+	void setCompressedRows(bool on);
+	void selectRelatedVertex(QListWidgetItem *item);
 	void highlightVertex();
 
 	void exportImagePNG();
@@ -103,6 +112,11 @@ private:
 	void setupUi(QMainWindow *MainWindow);
 	void retranslateUi(QMainWindow *MainWindow);
 	void makeDialogs(QMainWindow *MainWindow);
+	int currentVertexID();		// the vertex ID behind the browser selection, or -1
+	void loadRelatedVertices(int index);
+	enum {RELATED_VERTICES = 10};
+	QString browserEntry(int id);	// "(id) name"
+	unsigned long browserCursor;	// journal position the vertex browser is up to date with
 
 	RandomGraphDialog *randGraphDial;
 	KRegularGraphDialog *kregGraphDial;
@@ -141,11 +155,18 @@ private:
     QAction *actionImport_Graph;
     QAction *actionExport_Graph;
   QAction *actionMake_Undirected;
+  QAction *actionUndo;
+  QAction *actionRedo;
+  QAction *actionEstimate_Sample;
+  QAction *actionEstimate_Error;
+  QAction *actionStorage_Order;
+  QAction *actionCompressed_Rows;
     QWidget *centralwidget;
     QWidget *horizontalLayoutWidget_6;
     QHBoxLayout *top_button_bar;
     QPushButton *addVertexButton;
     QPushButton *addEdgeButton;
+    QPushButton *removeVertexButton;
     QPushButton *zoomInButton;
     QPushButton *zoomOutButton;
     QPushButton *toggleAxesButton;
@@ -188,12 +209,17 @@ private:
     QLCDNumber *lcdNumber_ClosenessCentrality;
     QLabel *label_ClusteringCoefficient;
     QLCDNumber *lcdNumber_ClusteringCoefficient;
+    QLabel *label_Eccentricity;
+    QLCDNumber *lcdNumber_Eccentricity;
     QWidget *gridLayoutWidget;
     QGridLayout *gridLayout;
     QComboBox *vertexSelectorComboBox;
     QPushButton *zoomToVertex;
     QLabel *label_Vertex;
     QWidget *tab_layout;
+    QWidget *tab_related;
+    QLabel *label_Related;
+    QListWidget *listWidget_Related;
     QGroupBox *layoutOptionsGroup;
     QWidget *verticalLayoutWidget;
     QVBoxLayout *verticalLayout;
@@ -240,6 +266,7 @@ private:
     QMenu *menuAnalysis;
     QMenu *menuGraph_Data;
     QMenu *menuVertex_Data;
+    QMenu *menuEdit;
     QMenu *menuGraph;
     QMenu *menuGenerate_Graph;
     QMenu *menuView;
@@ -0,0 +1,367 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE: MappedGraph.cpp
+*  	DESCRIPTION: Implementation of the memory mapped CSR graph
+*	URL: http://www.babelgraph.org/
+*/
+
+#include "MappedGraph.hpp"
+#include "GraphKernels.hpp"
+#include<fstream>
+#include<cstring>
+#include<vector>
+#include<algorithm>
+
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+//------------------------------------------------------------------------------
+MappedGraph::MappedGraph()
+{
+	base = NULL;
+	length = 0;
+	#ifdef _WIN32
+	fileHandle = mappingHandle = NULL;
+	#else
+	fd = -1;
+	#endif
+	header = NULL;
+}
+//------------------------------------------------------------------------------
+MappedGraph::~MappedGraph()
+{
+	close();
+}
+//------------------------------------------------------------------------------
+bool MappedGraph::open(const string &filename)
+{
+	close();
+
+	#ifdef _WIN32
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER size;
+	GetFileSizeEx(file, &size);
+	length = (size_t) size.QuadPart;
+	HANDLE mapping = (length > 0) ? CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+	base = (mapping != NULL) ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+	fileHandle = file;
+	mappingHandle = mapping;
+	#else
+	fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat info;
+	if (fstat(fd, &info) == 0)
+		length = info.st_size;
+	if (length > 0)
+	{
+		base = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+		if (base == MAP_FAILED)
+			base = NULL;
+	}
+	#endif
+
+	if ((base == NULL) || (length < sizeof(Header)))
+	{
+		close();
+		return false;
+	}
+
+	// check the header before trusting any of the offsets in it: each
+	// section has to start past the header, aligned for what it holds, and
+	// end inside the file
+	header = (const Header *) base;
+	long long n = header->numVertices, m = header->numArcs;
+	bool ok = (memcmp(header->magic, "BGCSR001", 8) == 0) && (header->byteOrder == BYTE_ORDER_MARK)
+		&& (n >= 0) && (m >= 0) && (n < INT_MAX) && (m < INT_MAX);
+	if (ok)
+	{
+		long long starts[] = {header->outOffsetsAt, header->outNeighborsAt, header->outWeightsAt,
+			header->inOffsetsAt, header->inNeighborsAt, header->vidsAt, header->xAt, header->yAt, header->zAt};
+		long long sizes[] = {(n + 1) * 8, m * 4, m * 4, (n + 1) * 8, m * 4, n * 4, n * 4, n * 4, n * 4};
+		for (int s = 0; ok && (s < 9); s++)
+		{
+			long long alignment = ((s == 0) || (s == 3)) ? 8 : 4;
+			ok = (starts[s] >= (long long) sizeof(Header)) && (starts[s] % alignment == 0)
+				&& (starts[s] <= (long long) length) && (sizes[s] <= (long long) length - starts[s]);
+		}
+	}
+	if (!ok)
+	{
+		close();
+		return false;
+	}
+
+	const char *bytes = (const char *) base;
+	outOffsets = (const long long *)(bytes + header->outOffsetsAt);
+	outNeighbors = (const int *)(bytes + header->outNeighborsAt);
+	outWeight = (const float *)(bytes + header->outWeightsAt);
+	inOffsets = (const long long *)(bytes + header->inOffsetsAt);
+	inNeighbors = (const int *)(bytes + header->inNeighborsAt);
+	denseToVID = (const int *)(bytes + header->vidsAt);
+	xPos = (const float *)(bytes + header->xAt);
+	yPos = (const float *)(bytes + header->yAt);
+	zPos = (const float *)(bytes + header->zAt);
+
+	// then what the sections hold, since the kernels index straight off the
+	// offsets and neighbors; this reads them all once
+	if (!checkRows(outOffsets, outNeighbors, n, m) || !checkRows(inOffsets, inNeighbors, n, m)
+		|| !checkVIDs(denseToVID, n))
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+//------------------------------------------------------------------------------
+bool MappedGraph::checkRows(const long long *offsets, const int *neighbors, long long n, long long m)
+{
+	// from 0 up to the arc count without ever going down, and every
+	// neighbor a vertex
+	if ((offsets[0] != 0) || (offsets[n] != m))
+		return false;
+	for (long long v = 0; v < n; v++)
+		if (offsets[v + 1] < offsets[v])
+			return false;
+	for (long long a = 0; a < m; a++)
+		if ((neighbors[a] < 0) || (neighbors[a] >= n))
+			return false;
+	return true;
+}
+//------------------------------------------------------------------------------
+bool MappedGraph::checkVIDs(const int *vids, long long n)
+{
+	// no vertex ID negative or given twice
+	vector<int> sorted (vids, vids + n);
+	sort(sorted.begin(), sorted.end());
+	return sorted.empty() || ((sorted[0] >= 0) && (adjacent_find(sorted.begin(), sorted.end()) == sorted.end()));
+}
+//------------------------------------------------------------------------------
+void MappedGraph::close()
+{
+	#ifdef _WIN32
+	if (base != NULL)
+		UnmapViewOfFile(base);
+	if (mappingHandle != NULL)
+		CloseHandle((HANDLE) mappingHandle);
+	if (fileHandle != NULL)
+		CloseHandle((HANDLE) fileHandle);
+	fileHandle = mappingHandle = NULL;
+	#else
+	if (base != NULL)
+		munmap(base, length);
+	if (fd >= 0)
+		::close(fd);
+	fd = -1;
+	#endif
+
+	base = NULL;
+	length = 0;
+	header = NULL;
+}
+//------------------------------------------------------------------------------
+bool MappedGraph::isOpen() const
+{
+	return header != NULL;
+}
+//------------------------------------------------------------------------------
+bool MappedGraph::write(const string &filename, const GraphSnapshot &snapshot, bool directed,
+	const float *x, const float *y, const float *z)
+{
+	ofstream out (filename.c_str(), ios::out | ios::binary | ios::trunc);
+	if (!out)
+		return false;
+
+	long long n = snapshot.getNumVertices(), m = snapshot.getNumEdges();
+
+	// lay the sections out one after another, each rounded up to 8 bytes
+	Header h;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, "BGCSR001", 8);
+	h.byteOrder = BYTE_ORDER_MARK;
+	h.flags = directed ? DIRECTED_FLAG : 0;
+	h.numVertices = n;
+	h.numArcs = m;
+	long long at = sizeof(Header);
+	long long *sections[] = {&h.outOffsetsAt, &h.outNeighborsAt, &h.outWeightsAt, &h.inOffsetsAt,
+		&h.inNeighborsAt, &h.vidsAt, &h.xAt, &h.yAt, &h.zAt};
+	long long sizes[] = {(n + 1) * 8, m * 4, m * 4, (n + 1) * 8, m * 4, n * 4, n * 4, n * 4, n * 4};
+	for (int s = 0; s < 9; s++)
+	{
+		at = (at + 7) & ~7LL;
+		*sections[s] = at;
+		at += sizes[s];
+	}
+
+	out.write((const char *) &h, sizeof(h));
+
+	// every section is written from the snapshot a row (or value) at a time
+	const char padding[8] = {0};
+	vector<long long> offsets (n + 1);
+	vector<int> ints (n);
+	vector<float> floats (n);
+	for (int s = 0; s < 9; s++)
+	{
+		long long pad = *sections[s] - (long long) out.tellp();
+		out.write(padding, pad);
+
+		switch (s)
+		{
+			case 0:
+			case 3:
+				offsets[0] = 0;
+				for (int v = 0; v < n; v++)
+					offsets[v + 1] = offsets[v] + ((s == 0) ? snapshot.getOutDegree(v) : snapshot.getInDegree(v));
+				out.write((const char *) &offsets[0], (n + 1) * 8);
+				break;
+			case 1:
+				for (int v = 0; v < n; v++)
+					out.write((const char *) snapshot.outBegin(v), snapshot.getOutDegree(v) * 4);
+				break;
+			case 2:
+				for (int v = 0; v < n; v++)
+					out.write((const char *) snapshot.outWeights(v), snapshot.getOutDegree(v) * 4);
+				break;
+			case 4:
+				for (int v = 0; v < n; v++)
+					out.write((const char *) snapshot.inBegin(v), snapshot.getInDegree(v) * 4);
+				break;
+			case 5:
+				for (int v = 0; v < n; v++)
+					ints[v] = snapshot.getVID(v);
+				out.write((const char *) ints.data(), n * 4);
+				break;
+			default:
+			{
+				const float *pos = (s == 6) ? x : ((s == 7) ? y : z);
+				for (int v = 0; v < n; v++)
+					floats[v] = (pos != NULL) ? pos[snapshot.getVID(v)] : 0;
+				out.write((const char *) floats.data(), n * 4);
+			}
+		}
+	}
+
+	out.close();
+	return !out.fail();
+}
+//------------------------------------------------------------------------------
+void MappedGraph::advise(ACCESS pattern)
+{
+	if (base == NULL)
+		return;
+
+	#ifndef _WIN32
+	int advice[] = {MADV_NORMAL, MADV_SEQUENTIAL, MADV_RANDOM, MADV_WILLNEED};
+	madvise(base, length, advice[pattern]);
+	#endif
+}
+//------------------------------------------------------------------------------
+int MappedGraph::getNumVertices() const
+{
+	return (int) header->numVertices;
+}
+//------------------------------------------------------------------------------
+int MappedGraph::getNumEdges() const
+{
+	return (int) header->numArcs;
+}
+//------------------------------------------------------------------------------
+bool MappedGraph::checkDirected() const
+{
+	return (header->flags & DIRECTED_FLAG) != 0;
+}
+//------------------------------------------------------------------------------
+int MappedGraph::getVID(int denseIndex) const
+{
+	return denseToVID[denseIndex];
+}
+//------------------------------------------------------------------------------
+size_t MappedGraph::getFileSize() const
+{
+	return length;
+}
+//------------------------------------------------------------------------------
+PageRankReport MappedGraph::pageRank(vector<float> &rank, float damping, double tolerance, int maxIterations) const
+{
+	PageRankReport report;
+	report.iterations = GraphKernels::pageRank(*this, rank, damping, tolerance, maxIterations, report.residual);
+	report.converged = (report.residual < tolerance);
+	return report;
+}
+//------------------------------------------------------------------------------
+void MappedGraph::pathMetrics(PathMetrics &metrics) const
+{
+	// a search per source as in GraphSnapshot::pathMetrics(), which also
+	// works out the averages
+	int size = getNumVertices();
+	metrics.sums.assign(size, 0);
+	metrics.reached.assign(size, 0);
+	metrics.eccentricity.assign(size, 0);
+	metrics.histogram.clear();
+
+	#pragma omp parallel
+	{
+		vector<int> hops;
+		vector<long long> histogram;
+
+		#pragma omp for schedule(dynamic, 16)
+		for (int s = 0; s < size; s++)
+		{
+			GraphKernels::bfsDistances(*this, s, hops);
+
+			double sum = 0;
+			int count = 0, farthest = 0;
+			for (int v = 0; v < size; v++)
+			{
+				int d = hops[v];
+				if (d < 0)
+					continue;	// not reachable
+
+				sum += d;
+				count++;
+				if (d > farthest)
+					farthest = d;
+				if (v != s)
+				{
+					if (d >= (int) histogram.size())
+						histogram.resize(d + 1, 0);
+					histogram[d]++;
+				}
+			}
+			metrics.sums[s] = sum;
+			metrics.reached[s] = count;
+			metrics.eccentricity[s] = farthest;
+		}
+
+		#pragma omp critical
+		{
+			if (histogram.size() > metrics.histogram.size())
+				metrics.histogram.resize(histogram.size(), 0);
+			for (unsigned int b = 0; b < histogram.size(); b++)
+				metrics.histogram[b] += histogram[b];
+		}
+	}
+
+	GraphSnapshot::averagePathMetrics(metrics);
+}
@@ -0,0 +1,130 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE:  MappedGraph.hpp
+*  	DESCRIPTION:  Header file for a read-only graph served straight from a
+*					memory mapped CSR file
+*	URL: http://www.babelgraph.org/
+*/
+
+#ifndef MAPPEDGRAPH_HPP_
+#define MAPPEDGRAPH_HPP_
+
+#include<string>
+#include<cstddef>
+
+#include "GraphSnapshot.hpp"
+
+using namespace std;
+
+// A MappedGraph opens a binary CSR file (written by MappedGraph::write(),
+// see NiceGraph::saveToMappedFile()) by mapping it into memory instead of
+// reading it.  Nothing is loaded up front: the operating system faults
+// pages in as the rows are touched and can drop them again under memory
+// pressure, so graphs far bigger than would fit next to the GUI can still
+// be analysed.  advise() passes access hints on to the pager.  open() does
+// read the rows through once, to turn away a damaged file whose offsets or
+// neighbors would send the kernels outside it.
+//
+// It has the same rows as a GraphSnapshot, so the kernels in
+// GraphKernels.hpp run on it directly.  It is read-only; GraphWidget shows
+// and analyses a .bgcsr file through one until the first edit, when
+// NiceGraph::loadFromMappedFile() turns it into an editable graph.
+//
+// File layout (native byte order, every section 8 byte aligned):
+//	header: magic "BGCSR001", byte order mark, flags, vertex and arc counts,
+//			and the file offset of each section
+//	out offsets (n+1 x int64), out neighbors (m x int32), out weights (m x float)
+//	in offsets (n+1 x int64), in neighbors (m x int32)
+//	dense index --> vertex ID (n x int32), x, y, z positions (n x float each)
+
+class MappedGraph {
+
+	public:
+	MappedGraph();
+	~MappedGraph();
+
+	bool open(const string &filename);	// returns false (and stays closed) if the file isn't usable
+	void close();
+	bool isOpen() const;
+
+	// writes snapshot as a file open() can map; the positions are indexed by
+	// vertex ID, as NiceGraph keeps them, and may be NULL
+	static bool write(const string &filename, const GraphSnapshot &snapshot, bool directed,
+		const float *x, const float *y, const float *z);
+
+	enum ACCESS {NORMAL_ACCESS = 0, SEQUENTIAL_ACCESS, RANDOM_ACCESS, WILL_NEED};
+	void advise(ACCESS pattern);		// a hint only, ignored where unsupported
+
+	// Sizes
+	int getNumVertices() const;
+	int getNumEdges() const;		// directed arcs, like GraphSnapshot
+	bool checkDirected() const;
+	int getVID(int denseIndex) const;
+
+	// Rows, all indices dense
+	typedef GraphSnapshot::Row Row;
+	Row outRow(int v) const { Row r = {outNeighbors + outOffsets[v], outNeighbors + outOffsets[v+1]}; return r; }
+	Row inRow(int v) const { Row r = {inNeighbors + inOffsets[v], inNeighbors + inOffsets[v+1]}; return r; }
+	const float * outWeights(int v) const { return outWeight + outOffsets[v]; }
+	int getOutDegree(int v) const { return (int)(outOffsets[v+1] - outOffsets[v]); }
+	int getInDegree(int v) const { return (int)(inOffsets[v+1] - inOffsets[v]); }
+
+	// Positions, by dense index
+	const float * getXPositions() const { return xPos; }
+	const float * getYPositions() const { return yPos; }
+	const float * getZPositions() const { return zPos; }
+
+	size_t getFileSize() const;
+
+	// Analyses straight off the rows, as GraphSnapshot has them; the path
+	// measures count hops, whatever the weights
+	PageRankReport pageRank(vector<float> &rank, float damping = 0.85, double tolerance = 1e-6, int maxIterations = 100) const;
+	void pathMetrics(PathMetrics &metrics) const;
+
+	private:
+	struct Header {
+		char magic[8];
+		unsigned int byteOrder;
+		unsigned int flags;
+		long long numVertices, numArcs;
+		long long outOffsetsAt, outNeighborsAt, outWeightsAt;
+		long long inOffsetsAt, inNeighborsAt;
+		long long vidsAt, xAt, yAt, zAt;
+	};
+	enum {DIRECTED_FLAG = 1, BYTE_ORDER_MARK = 0x01020304};
+
+	void *base;
+	size_t length;
+	#ifdef _WIN32
+	void *fileHandle, *mappingHandle;
+	#else
+	int fd;
+	#endif
+
+	const Header *header;
+	const long long *outOffsets, *inOffsets;
+	const int *outNeighbors, *inNeighbors, *denseToVID;
+	const float *outWeight, *xPos, *yPos, *zPos;
+
+	static bool checkRows(const long long *offsets, const int *neighbors, long long n, long long m);
+	static bool checkVIDs(const int *vids, long long n);
+
+	// no copying
+	MappedGraph(const MappedGraph &);
+	MappedGraph & operator=(const MappedGraph &);
+
+};
+
+#endif // MAPPEDGRAPH_HPP_
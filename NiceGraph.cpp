@@ -26,56 +26,84 @@
 //------------------------------------------------------------------------------
 NiceGraph::NiceGraph()
 {
-	edgeIDCounter = 0;
-	vertexIDCounter = 0;
 	isDirected = true; // the default is a directed graph
 				// call makeUndirected() to change this
+	compressedRows = false;
+	nextVersion();
 }
 //------------------------------------------------------------------------------
 NiceGraph::~NiceGraph()
 {
-	// destroy vertices
-	for (map<int,Vertex*>::iterator iter = vertexList.begin(); iter != vertexList.end(); iter++)
+	clearStorage();
+}
+//------------------------------------------------------------------------------
+void NiceGraph::clearStorage()
+{
+	// vertices hold maps, so run their destructors
+	for (int iter = vertexList.begin(); iter != vertexList.end(); iter = vertexList.next(iter))
 	{
-		if (iter->second != NULL) delete iter->second;
+		vertexPool.release(vertexList[iter]);
 	}
 
-	// destroy edges
-	for (map<int,Edge*>::iterator iter = edgeList.begin(); iter != edgeList.end(); iter++)
-	{
-		if (iter->second != NULL) delete iter->second;
-	}
+	// edges are plain data, just give back the blocks in one go
+	vertexPool.clear();
+	edgePool.clear();
+
+	vertexList.clear();
+	edgeList.clear();
+	edgeIndex.clear();
+	positions.clear();
+	names.clear();
+	vertexAttributes.clear();
+	edgeAttributes.clear();
+	vertexOrder.clear();
+	invalidateSnapshot();
+}
+//------------------------------------------------------------------------------
+void NiceGraph::getMemoryUsage(size_t &liveBytes, size_t &reservedBytes)
+{
+	liveBytes = vertexPool.liveBytes() + edgePool.liveBytes();
+	reservedBytes = vertexPool.reservedBytes() + edgePool.reservedBytes() + names.bytes()
+		+ vertexAttributes.bytes() + edgeAttributes.bytes();
 }
 // Graph create/manipulate structure
 //------------------------------------------------------------------------------
 void NiceGraph::makeEmptyGraph(int numVertices)
 {
+	journal.beginEdit();
 	for (int index = 0; index < numVertices; index++)
 	{
 		addVertex();
 	}
+	journal.endEdit();
 }
 //------------------------------------------------------------------------------
 void NiceGraph::makeCompleteGraph(int numVertices)
 {
+	journal.beginEdit();	// the whole graph is one step
 	makeEmptyGraph(numVertices); 	// first initialize all the vertices
 	
 	// now loop through all possible edges and create them
+	vector<pair<int,int> > edges;
+	edges.reserve((size_t) numVertices * (numVertices - 1));
 	for (int froms = 0; froms < numVertices; froms++)
 	{
 		for (int tos = 0; tos < numVertices; tos++)
 		{
 			if ((froms != tos) && (froms < tos))
 			{
-				addEdge(froms,tos);
-				addEdge(tos,froms);
+				edges.push_back(make_pair(froms,tos));
+				edges.push_back(make_pair(tos,froms));
 			}
 		}
 	}
+	addEdges(edges);
+	journal.endEdit();
 }
 //------------------------------------------------------------------------------
 void NiceGraph::makeRandomGraph(int numVertices, float density)
 {
+	journal.beginEdit();	// the whole graph is one step
 
 	makeEmptyGraph(numVertices); 	// first initialize all the vertices
 	
@@ -87,6 +115,12 @@ void NiceGraph::makeRandomGraph(int numVertices, float density)
 	if ((density > 0) && (total < 1))
 		total = 1;
 
+	// collect the edges first and add them in one batch, remembering the
+	// ones already picked (self loops are never remembered, and addEdges
+	// drops them)
+	vector<pair<int,int> > edges;
+	EdgeIndex picked;
+
 	while (total > 0)
 	{
 		int v1 =   rand() % numVertices;
@@ -94,26 +128,32 @@ void NiceGraph::makeRandomGraph(int numVertices, float density)
 
 		if (isDirected)		// directed graph
 		{
-			if (!testFromToConnected(v1,v2))
+			if ((picked.find(v1,v2) < 0) && !testFromToConnected(v1,v2))
 			{
-				addEdge(v1,v2);
+				edges.push_back(make_pair(v1,v2));
+				if (v1 != v2)
+					picked.insert(v1,v2,1);
 				total--;
 			}
 		}
 		else			// undirected graph
 		{
-			if (!testConnected(v1,v2))
+			if ((picked.find(v1,v2) < 0) && (picked.find(v2,v1) < 0) && !testConnected(v1,v2))
 			{
-				addEdge(v1,v2);
-				addEdge(v2,v1);
+				edges.push_back(make_pair(v1,v2));
+				if (v1 != v2)
+					picked.insert(v1,v2,1);
 				total--; total--;
 			}
 		}
 	}
+	addEdges(edges);
+	journal.endEdit();
 }
 //------------------------------------------------------------------------------
 void NiceGraph::makeKRegularGraph (int numVertices, int k)
 {
+	journal.beginEdit();	// the whole graph is one step
 	makeEmptyGraph(numVertices); 	// first initialize all the vertices
 
 	int maxIndex = numVertices - 1;
@@ -124,6 +164,8 @@ void NiceGraph::makeKRegularGraph (int numVertices, int k)
 	// special case k = 1?
 
 	// now add k-neighbors to each one
+	vector<pair<int,int> > edges;
+	edges.reserve((size_t) numVertices * k);
 	for (int i = 0; i < numVertices; i++)
 	{
 		for (int r = 1; r <= k/2; r++)
@@ -131,14 +173,17 @@ void NiceGraph::makeKRegularGraph (int numVertices, int k)
 			int next = i + r;
 			if ( next > maxIndex)
 				next = next - maxIndex - 1;
-			addEdge (i, next);
-			addEdge (next , i);
+			edges.push_back(make_pair(i, next));
+			edges.push_back(make_pair(next, i));
 		}
 	}
+	addEdges(edges);
+	journal.endEdit();
 }
 //------------------------------------------------------------------------------
 void NiceGraph::makeStrangersBanquetGraph(int numVertices, int groups, float density, float mu)
 {
+	journal.beginEdit();	// the whole graph is one step
 
 	makeEmptyGraph(numVertices); 	// first initialize all the vertices
 
@@ -160,22 +205,25 @@ void NiceGraph::makeStrangersBanquetGraph(int numVertices, int groups, float den
 	int total_edges = numVertices * (numVertices - 1) / 2;
 	vector<Edge> proposals (total_edges);
 	
-	int edgeIndex = 0;
+	int proposal = 0;
 	for (int froms = 0; froms < numVertices; froms++)
 	{
 		for (int tos = 0; tos < numVertices; tos++)
 		{
 			if ((froms != tos) && (froms < tos))
 			{
-				proposals[edgeIndex].from = vertexList[froms];
-				proposals[edgeIndex].to = vertexList[tos];
-				edgeIndex++;
+				proposals[proposal].from = vertexList[froms];
+				proposals[proposal].to = vertexList[tos];
+				proposal++;
 			}
 		}
 	}
-	// propose connections and build graph
+	// propose connections and build graph, collecting the accepted edges
+	// and adding them in one batch at the end
 	int num_edges = (int) (density * (float) total_edges);
 	int edge_counter = 0;
+	vector<pair<int,int> > edges;
+	EdgeIndex accepted;
 
 	    while (edge_counter < num_edges)
 	    {
@@ -186,13 +234,15 @@ void NiceGraph::makeStrangersBanquetGraph(int numVertices, int groups, float den
 	    	int vertex1 = proposals[randIndex].from->vID;
 	    	int vertex2 = proposals[randIndex].to->vID;
 	    	
-	    	if ((vertex1 != vertex2) && (!testConnected(vertex1,vertex2))) 			// if isn't itself, and aren't already connected
+	    	if ((vertex1 != vertex2) && (accepted.find(vertex1,vertex2) < 0) && (accepted.find(vertex2,vertex1) < 0)
+				&& (!testConnected(vertex1,vertex2))) 			// if isn't itself, and aren't already connected
     		{
 				// now check to see if they are accepted
 				if (vertexList[vertex1]->vColor == vertexList[vertex2]->vColor) 
 				{
 					// if same color approve match
-					addEdge(vertex1, vertex2);		// add edge
+					edges.push_back(make_pair(vertex1, vertex2));		// add edge
+					accepted.insert(vertex1, vertex2, 1);
 					edge_counter++;
 					if (!proposals.empty()) 
 						proposals.erase(proposals.begin()+randIndex);	// remove from list
@@ -207,7 +257,8 @@ void NiceGraph::makeStrangersBanquetGraph(int numVertices, int groups, float den
 							continue; // if either one rejects the connection do nothing
 					else	
 					{	// approve the connection
-						addEdge(vertex1, vertex2);		// add edge
+						edges.push_back(make_pair(vertex1, vertex2));		// add edge
+						accepted.insert(vertex1, vertex2, 1);
 						edge_counter++;
 						if (!proposals.empty()) 
 							proposals.erase(proposals.begin()+randIndex);	// remove from list
@@ -216,10 +267,13 @@ void NiceGraph::makeStrangersBanquetGraph(int numVertices, int groups, float den
 				}		
 		}
 	}
+	addEdges(edges);
+	journal.endEdit();
 }
 //------------------------------------------------------------------------------
 void NiceGraph::makeBinaryTreeGraph(int numVertices)
 {
+	journal.beginEdit();	// the whole graph is one step
 	makeEmptyGraph(numVertices); 	// first initialize all the vertices
 
 	queue<int> parents;
@@ -229,60 +283,140 @@ void NiceGraph::makeBinaryTreeGraph(int numVertices)
 		parents.push(q);
 	}
 
+	vector<pair<int,int> > edges;
 	while (!parents.empty())
 	{
 		int baby1 = 2*parents.front()+1 ;
 		int baby2 = 2*parents.front()+2 ;
 
 		if (baby1 < numVertices)
-			addEdge(parents.front(), baby1);
+			edges.push_back(make_pair(parents.front(), baby1));
 		if (baby2 < numVertices)
-			addEdge(parents.front(), baby2);
+			edges.push_back(make_pair(parents.front(), baby2));
 		parents.pop();
 	}
+	addEdges(edges);
+	journal.endEdit();
 }
 //------------------------------------------------------------------------------
-void NiceGraph::addVertex()
+int NiceGraph::addVertex()
 {
-	vertexList[vertexIDCounter] = new Vertex();
-	vertexList[vertexIDCounter]->vName = " ";
-	vertexList[vertexIDCounter]->vColor = YELLOW;
-	vertexList[vertexIDCounter]->vID = vertexIDCounter;
-	vertexIDCounter++;
+	// reuses the ID of a removed vertex if there is one
+	Vertex *newVertex = vertexPool.create();
+	int vertexID = vertexList.insert(newVertex);
+	if (vertexID >= positions.size())
+		positions.resize(vertexID + 1);
+	positions.set(vertexID, 0, 0, 0);
+	newVertex->vName = names.intern(" ");
+	newVertex->vColor = YELLOW;
+	newVertex->vID = vertexID;
+	vertexAttributes.addRow(vertexID);
+	invalidateSnapshot();
+
+	GraphChange change (GraphChange::VERTEX_ADDED, vertexID);
+	journal.record(change);
+	return vertexID;
 }
 //------------------------------------------------------------------------------
-void NiceGraph::addVertex(string newName)
+int NiceGraph::addVertex(string newName)
 {
-	addVertex();
-	vertexList[vertexIDCounter - 1]->vName = newName;
+	// the name is part of adding it, not a change of its own
+	int vertexID = addVertex();
+	vertexList[vertexID]->vName = names.intern(newName);
+	return vertexID;
 }
 //------------------------------------------------------------------------------
 void NiceGraph::removeVertex (int vertexID)
 {
-	// first make sure the vertex exists
+	set<int> single;
+	single.insert(vertexID);
+	removeVertices(single);
+}
+//------------------------------------------------------------------------------
+void NiceGraph::removeVertices (const set<int> &vertexIDs)
+{
+	// one sweep over the edges of the doomed vertices, found through their own
+	// maps: each edge is unhooked from the end that survives (the maps of the
+	// doomed vertices go away with them), then dropped from the index and
+	// recycled.  An edge between two doomed vertices shows up twice; the second
+	// time its ID is no longer valid, so it is skipped without being touched.
+	// The edges are journaled before the vertices so undo restores them after.
+	journal.beginEdit();
+	for (set<int>::const_iterator v = vertexIDs.begin(); v != vertexIDs.end(); v++)
+	{
+		if (!validVID(*v))
+			continue;
 
-	// then remove all neighboring edges (including those stored by the neighbors)
+		Vertex *doomed = vertexList[*v];
+		for (int side = 0; side < 2; side++)
+		{
+			map<int,Edge*> &edges = (side == 0) ? doomed->out : doomed->in;
+			for (map<int,Edge*>::iterator iter = edges.begin(); iter != edges.end(); iter++)
+			{
+				int edgeID = iter->first;
+				if (!validEID(edgeID))
+					continue;
 
-	// then remove the vertex itself
-	// delete the pointer to the vertex for memory then delete the vertex from the map
-	vertexList.erase(vertexID);
+				Edge *e = iter->second;
+				recordEdgeRemoval(e);
+				if (e->from == doomed)
+				{
+					if (vertexIDs.count(e->to->vID) == 0)
+						e->to->in.erase(edgeID);
+				}
+				else if (vertexIDs.count(e->from->vID) == 0)
+					e->from->out.erase(edgeID);
+
+				int fromID = e->from->vID, toID = e->to->vID;
+				edgeKey(fromID, toID);
+				edgeIndex.erase(fromID, toID);
+				edgeAttributes.removeRow(edgeID);
+				edgePool.release(e);
+				edgeList.erase(edgeID);
+			}
+		}
+	}
 
-	// update everyone else's edgeIDs for no confusioN!!
+	// now the vertices themselves, their IDs go on the free list
+	for (set<int>::const_iterator v = vertexIDs.begin(); v != vertexIDs.end(); v++)
+	{
+		if (!validVID(*v))
+			continue;
+
+		Vertex *doomed = vertexList[*v];
+		GraphChange change (GraphChange::VERTEX_REMOVED, *v);
+		change.text = names.get(doomed->vName);
+		change.color = doomed->vColor;
+		change.x = positions.xData()[*v];
+		change.y = positions.yData()[*v];
+		change.z = positions.zData()[*v];
+		for (int col = 0; col < vertexAttributes.getNumColumns(); col++)
+		{
+			change.row.push_back(vertexAttributes.getText(col, *v));
+			change.columns.push_back(vertexAttributes.getColumnName(col));
+		}
+		journal.record(change);
+
+		positions.set(*v, 0, 0, 0);
+		vertexAttributes.removeRow(*v);
+		vertexPool.release(vertexList[*v]);
+		vertexList.erase(*v);
+	}
+
+	invalidateSnapshot();
+	journal.endEdit();
 }
 //------------------------------------------------------------------------------
 void NiceGraph::addEdge (int fromID, int toID)
 {
 	// if not already connected, add the edge
 	// otherwise do nothing
-	// also, can't connect to self
+	// also, can't connect to self or to a vertex that isn't there
 
-	bool goFlag;
-	if (isDirected)	// directed graph
-		goFlag = !testFromToConnected(fromID,toID);
-	else 		// undirected graph
-		goFlag = !testConnected(fromID,toID);
+	// on an undirected graph both tests mean "connected either way"
+	bool goFlag = !testFromToConnected(fromID,toID);
 
-	if (fromID == toID)
+	if ((fromID == toID) || !validVID(fromID) || !validVID(toID))
 		goFlag = false;
 	
 	if (goFlag)
@@ -290,45 +424,141 @@ void NiceGraph::addEdge (int fromID, int toID)
 		Vertex *vFrom = vertexList[fromID];
 		Vertex *vTo = vertexList[toID];
 
-		Edge *newEdge = new Edge();
+		Edge *newEdge = edgePool.create();
 
-		edgeList[edgeIDCounter] = newEdge;
-		edgeList[edgeIDCounter]->from = vFrom;
-		edgeList[edgeIDCounter]->to = vTo;
-		edgeList[edgeIDCounter]->eID = edgeIDCounter;
+		int edgeID = edgeList.insert(newEdge);
+		newEdge->from = vFrom;
+		newEdge->to = vTo;
+		newEdge->eID = edgeID;
 
 		// DEFAULT WEIGHT UNLESS OTHERWISE SPECIFIED
-		edgeList[edgeIDCounter]->weight = 1.0;
-		
-		// also add the edge to the vertex neighbor list
-		vFrom->out[edgeIDCounter] = newEdge;
-		vTo->in[edgeIDCounter] = newEdge;
+		newEdge->weight = 1.0;
 		
-		if (!isDirected)	// add the reciprocal edge if the graph is not directed
-			addEdge(toID,fromID);
-	
-		edgeIDCounter++;
+		// also add the edge to the vertex neighbor list and the edge index;
+		// an undirected edge is stored once and the views show it from both ends
+		vFrom->out[edgeID] = newEdge;
+		vTo->in[edgeID] = newEdge;
+		edgeKey(fromID, toID);
+		edgeIndex.insert(fromID, toID, edgeID);
+		edgeAttributes.addRow(edgeID);
+		invalidateSnapshot();
+		recordEdgeAddition(newEdge);
 	}
 }
 //------------------------------------------------------------------------------
-void NiceGraph::removeEdge (int from, int to)
-{	
-	bool okflag;
-	if (isDirected)
-		okflag = testFromToConnected(from,to);
-	else
-		okflag = testConnected(from,to);
+int NiceGraph::addEdges (const vector<pair<int,int> > &edges, const vector<float> &weights)
+{
+	// same rules as addEdge: no self loops, no duplicates, and on undirected
+	// graphs (a,b) and (b,a) are the same edge.  Sorting the requests puts
+	// duplicates next to each other; the position breaks ties so the first
+	// request for a pair is the one that is kept.
+	int n = edges.size();
+	vector<pair<pair<int,int>,int> > sorted;
+	sorted.reserve(n);
+	for (int i = 0; i < n; i++)
+	{
+		int fromID = edges[i].first;
+		int toID = edges[i].second;
+		if ((fromID == toID) || !validVID(fromID) || !validVID(toID))
+			continue;
+		if (!isDirected && (toID < fromID))
+			swap(fromID, toID);
+		sorted.push_back(make_pair(make_pair(fromID, toID), i));
+	}
+	sort(sorted.begin(), sorted.end());
 
-	// test connected first to make sure the connection exists
-	if (okflag)
+	vector<bool> keep (n, false);
+	int numNew = 0;
+	for (unsigned int s = 0; s < sorted.size(); s++)
 	{
-		int edgeID = getEdgeID(from,to);
+		if ((s > 0) && (sorted[s].first == sorted[s-1].first))
+			continue;
+
+		int fromID = sorted[s].first.first;
+		int toID = sorted[s].first.second;
+		if (!testFromToConnected(fromID, toID))
+		{
+			keep[sorted[s].second] = true;
+			numNew++;
+		}
+	}
+
+	if (numNew == 0)
+		return 0;
 
-		removeEdge(edgeID);
+	edgeList.reserve(edgeList.idLimit() + numNew);
+	edgeIndex.reserve(edgeIndex.size() + numNew);
 
-		if (!isDirected)
-			removeEdge(to,from);
+	// now build the edges in the order they were given
+	vector<Edge*> added;
+	added.reserve(numNew);
+	for (int i = 0; i < n; i++)
+	{
+		if (!keep[i])
+			continue;
+
+		int fromID = edges[i].first;
+		int toID = edges[i].second;
+
+		Edge *newEdge = edgePool.create();
+		int edgeID = edgeList.insert(newEdge);
+		newEdge->from = vertexList[fromID];
+		newEdge->to = vertexList[toID];
+		newEdge->eID = edgeID;
+		newEdge->weight = (i < (int) weights.size()) ? weights[i] : 1.0;
+		edgeKey(fromID, toID);
+		edgeIndex.insert(fromID, toID, edgeID);
+		edgeAttributes.addRow(edgeID);
+		added.push_back(newEdge);
+	}
+
+	journal.beginEdit();
+	for (int i = 0; i < numNew; i++)
+		recordEdgeAddition(added[i]);
+	journal.endEdit();
+
+	// then hook them into the adjacency maps one vertex at a time, so each
+	// map stays in cache while its edges go in.  A counting sort by vertex ID
+	// keeps the edges of each vertex in ID order, and new IDs are usually the
+	// largest so far, so the inserts are hinted at the end.
+	int limit = vertexList.idLimit();
+	vector<int> start (limit + 1, 0);
+	vector<Edge*> grouped (numNew);
+
+	for (int i = 0; i < numNew; i++)
+		start[added[i]->from->vID + 1]++;
+	for (int v = 0; v < limit; v++)
+		start[v + 1] += start[v];
+	for (int i = 0; i < numNew; i++)
+		grouped[start[added[i]->from->vID]++] = added[i];
+	for (int i = 0; i < numNew; i++)
+	{
+		Vertex *vFrom = grouped[i]->from;
+		vFrom->out.insert(vFrom->out.end(), make_pair(grouped[i]->eID, grouped[i]));
 	}
+
+	start.assign(limit + 1, 0);
+	for (int i = 0; i < numNew; i++)
+		start[added[i]->to->vID + 1]++;
+	for (int v = 0; v < limit; v++)
+		start[v + 1] += start[v];
+	for (int i = 0; i < numNew; i++)
+		grouped[start[added[i]->to->vID]++] = added[i];
+	for (int i = 0; i < numNew; i++)
+	{
+		Vertex *vTo = grouped[i]->to;
+		vTo->in.insert(vTo->in.end(), make_pair(grouped[i]->eID, grouped[i]));
+	}
+
+	invalidateSnapshot();
+	return numNew;
+}
+//------------------------------------------------------------------------------
+void NiceGraph::removeEdge (int from, int to)
+{	
+	// getEdgeID returns -1 if the connection doesn't exist, and removing
+	// edge -1 does nothing
+	removeEdge(getEdgeID(from,to));
 }
 //------------------------------------------------------------------------------
 void NiceGraph::removeEdge (int edgeID)
@@ -343,54 +573,38 @@ void NiceGraph::removeEdge (int edgeID)
 
 		vfrom = edgeList[edgeID]->from;
 		vto = edgeList[edgeID]->to;
+		recordEdgeRemoval(edgeList[edgeID]);
 		
 		// remove edge from neighbors vectors of both from and to
 		vfrom->out.erase(edgeID);
 		vto->in.erase(edgeID);
-		if (!isDirected)
-		{
-			vfrom->in.erase(edgeID);
-			vto->out.erase(edgeID);	
-		}
 
-		// remove edge from the MAP edgeList
+		// remove edge from the index and the edgeList, its ID goes on the free list
+		int fromID = vfrom->vID, toID = vto->vID;
+		edgeKey(fromID, toID);
+		edgeIndex.erase(fromID, toID);
+		edgeAttributes.removeRow(edgeID);
+		edgePool.release(edgeList[edgeID]);	// and its memory gets recycled
 		edgeList.erase(edgeID);
+		invalidateSnapshot();
 	}
-
-	// also what about the memory leak aspect of the edge, does that get erased, too?
-
-
 }
 //------------------------------------------------------------------------------
 int NiceGraph::getEdgeID(int vertexID1, int vertexID2)
 {
 
-	// NOTE: for undirected graphs there will be two distint EDGE IDs representing
-	// basically the same thing.
-
-	int edgeID = -1;
+	// NOTE: an undirected edge has just one ID, found from either end
 
-	// make sure it even exists, return -1 as an error code if we can't find it
-	if (!testFromToConnected(vertexID1, vertexID2) && isDirected)
-		return -1;
-	if (!testFromToConnected(vertexID1, vertexID2) && isDirected)
-		return -1;
-
-	// now find the associated edgeid
-
-	Vertex *vFrom = vertexList[vertexID1];
-	
-	map<int,Edge*> *temp = &vFrom->out;
-
-	for (map<int,Edge*>::iterator iter = temp->begin(); iter != temp->end(); iter++)
-	{
-		Edge* eTemp = iter->second;
-
-		if (eTemp->to->vID == vertexID2)
-			edgeID = iter->first;
-	}
-	
-	return edgeID;	// return edge id
+	// returns -1 as an error code if we can't find it
+	edgeKey(vertexID1, vertexID2);
+	return edgeIndex.find(vertexID1, vertexID2);
+}
+//------------------------------------------------------------------------------
+void NiceGraph::edgeKey(int &from, int &to)
+{
+	// undirected edges are indexed with the smaller vertex ID first
+	if (!isDirected && (to < from))
+		swap(from, to);
 }
 //------------------------------------------------------------------------------
 int NiceGraph::getNumVertices()
@@ -405,16 +619,21 @@ int NiceGraph::getNumEdges()
 //------------------------------------------------------------------------------
 int NiceGraph::getDegree (int vertexID) 
 {
-	return getInDegree(vertexID) + getOutDegree(vertexID);
+	// an undirected edge is in exactly one of the two maps
+	return vertexList[vertexID]->in.size() + vertexList[vertexID]->out.size();
 }
 //------------------------------------------------------------------------------
 int NiceGraph::getInDegree (int vertexID) 
 {
+	if (!isDirected)
+		return getDegree(vertexID);
 	return vertexList[vertexID]->in.size();
 }
 //------------------------------------------------------------------------------
 int NiceGraph::getOutDegree (int vertexID) 
 {
+	if (!isDirected)
+		return getDegree(vertexID);
 	return vertexList[vertexID]->out.size();
 }
 //------------------------------------------------------------------------------
@@ -427,43 +646,16 @@ float NiceGraph::getWeight(int from, int to)
 //------------------------------------------------------------------------------
 bool NiceGraph::testConnected (int vertexID1, int vertexID2)
 {
-	// if it's an undirected graph, only need to check on vertex's neighborhood
-
-	vector<int> temp = getNeighborList(vertexID1);
-
-	if (temp.empty())	
-		return false;	// if vertex doesn't have any neighors	
-	else 
-	{
-		vector<int>::iterator it;
-		it = find(temp.begin(), temp.end(), vertexID2);
-		if (it != temp.end())  
-			return true; 		// found the neighbor!
-	}
-	
-	return false;		// default, didn't find anything
+	// connected in either direction
+	if (!isDirected)
+		return getEdgeID(vertexID1, vertexID2) >= 0;
+	return (edgeIndex.find(vertexID1, vertexID2) >= 0) || (edgeIndex.find(vertexID2, vertexID1) >= 0);
 }
 //------------------------------------------------------------------------------
 bool NiceGraph::testFromToConnected (int vertexID1, int vertexID2)
 {
-
 	// on a directed graph, only check the outgoing neighbors
-
-	vector<int> temp = getOutNeighborList(vertexID1);
-
-	if (temp.empty())	
-		return false;	// if vertex doesn't have any neighors	
-	else 
-	{
-		vector<int>::iterator it;
-		it = find(temp.begin(), temp.end(), vertexID2);
-		if (it != temp.end())  
-			return true; 		// found the neighbor!						
-	}
-	
-	return false;		// default, didn't find anything
-
-
+	return getEdgeID(vertexID1, vertexID2) >= 0;
 }
 //------------------------------------------------------------------------------
 bool NiceGraph::checkDirected()
@@ -473,81 +665,114 @@ bool NiceGraph::checkDirected()
 //------------------------------------------------------------------------------
 void NiceGraph::makeUndirected()
 {
-	isDirected = false;
+	if (!isDirected)
+		return;
 
-	// now make matrix symmetric
-	for (map<int,Edge*>::iterator iter = edgeList.begin(); iter != edgeList.end(); iter++)
+	// where both A->B and B->A exist, keep the one with the lower ID (and
+	// its weight) as the undirected edge
+	vector<int> mirrors;
+	for (int iter = edgeList.begin(); iter != edgeList.end(); iter = edgeList.next(iter))
 	{
-		Edge *e = iter->second;
-		int id1 = e->from->vID;
-		int id2 = e->to->vID;
-		
-		// error checking to make sure they don't already exist happens automatically
-		addEdge(id2,id1);
+		Edge *e = edgeList[iter];
+		int mirror = edgeIndex.find(e->to->vID, e->from->vID);
+		if (mirror > iter)
+			mirrors.push_back(mirror);
 	}
+	journal.beginEdit();
+	for (unsigned int m = 0; m < mirrors.size(); m++)
+		removeEdge(mirrors[m]);
+
+	isDirected = false;
+	rebuildEdgeIndex();
+
+	GraphChange change (GraphChange::MADE_UNDIRECTED);
+	journal.record(change);
+	journal.endEdit();
 }
-// Neighbor(hood) related functions
 //------------------------------------------------------------------------------
-vector<int> NiceGraph::getNeighborList(int vertexID)
+void NiceGraph::makeDirected()
 {
+	// only for undoing makeUndirected(), each edge keeps its direction
+	isDirected = true;
+	rebuildEdgeIndex();
 
-	vector<int> total, in, out;
-
-	in = getInNeighborList(vertexID);
-	out = getOutNeighborList(vertexID);
-
-	total = in; // added in, now add outs, but check for duplicates
-
-	// check for duplicates
-	for (vector<int>::iterator I = out.begin(); I != out.end(); I++)
+	GraphChange change (GraphChange::MADE_DIRECTED);
+	journal.record(change);
+}
+//------------------------------------------------------------------------------
+void NiceGraph::rebuildEdgeIndex()
+{
+	// with the keys for the current isDirected
+	edgeIndex.clear();
+	edgeIndex.reserve(edgeList.size());
+	for (int iter = edgeList.begin(); iter != edgeList.end(); iter = edgeList.next(iter))
 	{
-		vector<int>::iterator it;
-		it = find(total.begin(), total.end(), *I);
-		if (it == total.end()) 
-			total.push_back(*I); 		// found the neighbor in ANOTHER SPOT! remove it!
+		int id1 = edgeList[iter]->from->vID;
+		int id2 = edgeList[iter]->to->vID;
+		edgeKey(id1, id2);
+		edgeIndex.insert(id1, id2, iter);
 	}
-
-	return total;
+	invalidateSnapshot();
+}
+// Neighbor(hood) related functions
+//------------------------------------------------------------------------------
+vector<int> NiceGraph::getNeighborList(int vertexID)
+{
+	// the ALL view already leaves out the duplicates
+	NeighborRange ns = getNeighbors(vertexID);
+	return vector<int>(ns.begin(), ns.end());
 }
 //---------------------------------------------------------------------------------
 vector<int> NiceGraph::getInNeighborList(int vertexID)
 {
-	map<int,Edge*> inList = vertexList[vertexID]->in;
-	vector<int> tempList;
-	
-	for (map<int,Edge*>::iterator iter = inList.begin(); iter != inList.end(); iter++)
-	{
-		Edge *tEdge = iter->second;
-
-		tempList.push_back(tEdge->from->vID);
-	}
-	return tempList;
+	NeighborRange ns = getInNeighbors(vertexID);
+	return vector<int>(ns.begin(), ns.end());
 }
 //---------------------------------------------------------------------------------
 vector<int> NiceGraph::getOutNeighborList(int vertexID)
 {
-	map<int,Edge*> outList = vertexList[vertexID]->out;
-
-	vector<int> tempList;
-	
-	for (map<int,Edge*>::iterator iter = outList.begin(); iter != outList.end(); iter++)
-	{
-		Edge*tEdge = iter->second;
-		
-		tempList.push_back(tEdge->to->vID);
-	}
-	return tempList;
+	NeighborRange ns = getOutNeighbors(vertexID);
+	return vector<int>(ns.begin(), ns.end());
+}
+//---------------------------------------------------------------------------------
+NeighborRange NiceGraph::getNeighbors(int vertexID)
+{
+	if (!isDirected)
+		return NeighborRange(vertexList[vertexID], NeighborRange::ALL_NEIGHBORS, NULL);
+	return NeighborRange(vertexList[vertexID], NeighborRange::ALL_NEIGHBORS, &edgeIndex);
+}
+//---------------------------------------------------------------------------------
+NeighborRange NiceGraph::getInNeighbors(int vertexID)
+{
+	if (!isDirected)
+		return getNeighbors(vertexID);
+	return NeighborRange(vertexList[vertexID], NeighborRange::IN_NEIGHBORS, &edgeIndex);
+}
+//---------------------------------------------------------------------------------
+NeighborRange NiceGraph::getOutNeighbors(int vertexID)
+{
+	if (!isDirected)
+		return getNeighbors(vertexID);
+	return NeighborRange(vertexList[vertexID], NeighborRange::OUT_NEIGHBORS, &edgeIndex);
 }
 // Graph Extrinsic properties
 //---------------------------------------------------------------------------------
 string NiceGraph::getVertexName(int vertexID)
 {
-	return vertexList[vertexID]->vName;
+	return names.get(vertexList[vertexID]->vName);
 }
 //---------------------------------------------------------------------------------
 void NiceGraph::setVertexName(int vertexID, string newName)
 {
-	vertexList[vertexID]->vName = newName;
+	GraphChange change (GraphChange::NAME_CHANGED, vertexID);
+	change.oldText = names.get(vertexList[vertexID]->vName);
+	change.text = newName;
+	if (newName == change.oldText)
+		return;		// not a change, so nothing to undo
+
+	vertexList[vertexID]->vName = names.intern(newName);
+	nextVersion();
+	journal.record(change);
 }
 //---------------------------------------------------------------------------------
 int NiceGraph::getVertexColor (int vertexID)
@@ -557,176 +782,230 @@ int NiceGraph::getVertexColor (int vertexID)
 //---------------------------------------------------------------------------------
 void NiceGraph::setVertexColor (int vertexID, int newColor)
 {
+	GraphChange change (GraphChange::COLOR_CHANGED, vertexID);
+	change.oldColor = vertexList[vertexID]->vColor;
+	change.color = newColor;
+	if (newColor == change.oldColor)
+		return;
+
 	vertexList[vertexID]->vColor = newColor;
+	nextVersion();
+	journal.record(change);
 }
 
-// Graph Analysis
 //---------------------------------------------------------------------------------
-void NiceGraph::avgShortestPathMatrix(map<int,float> &paths )
-{ 
-	// this approach based on Floyd-Warshall shortest paths algorithm (iterative!)
-	// returns -1 if the graph if some nodes are not reachable
-
-	int size = vertexList.size();
-
-	unsigned long int  distance[size][size];
-	
-	// initialize all values
-	for (int q = 0; q < size; q++)
+AttributeStore & NiceGraph::getVertexAttributes()
+{
+	return vertexAttributes;
+}
+//---------------------------------------------------------------------------------
+AttributeStore & NiceGraph::getEdgeAttributes()
+{
+	return edgeAttributes;
+}
+//---------------------------------------------------------------------------------
+void NiceGraph::setVertexAttribute(int col, int vertexID, string text)
+{
+	if ((col < 0) || (col >= vertexAttributes.getNumColumns()))
+		return;		// eg. undoing a change to a column removed since
+
+	GraphChange change (GraphChange::VERTEX_ATTRIBUTE_CHANGED, vertexID);
+	change.column = vertexAttributes.getColumnName(col);
+	change.oldText = vertexAttributes.getText(col, vertexID);
+	vertexAttributes.setText(col, vertexID, text);
+	change.text = vertexAttributes.getText(col, vertexID);	// as stored
+	if (change.text == change.oldText)
+		return;
+
+	// results can be computed from the columns too, so they go stale like names
+	nextVersion();
+	journal.record(change);
+}
+//---------------------------------------------------------------------------------
+void NiceGraph::setEdgeAttribute(int col, int edgeID, string text)
+{
+	if ((col < 0) || (col >= edgeAttributes.getNumColumns()))
+		return;
+
+	GraphChange change (GraphChange::EDGE_ATTRIBUTE_CHANGED, edgeID);
+	change.column = edgeAttributes.getColumnName(col);
+	change.oldText = edgeAttributes.getText(col, edgeID);
+	edgeAttributes.setText(col, edgeID, text);
+	change.text = edgeAttributes.getText(col, edgeID);
+	if (change.text == change.oldText)
+		return;
+
+	nextVersion();
+	journal.record(change);
+}
+// Change journal, undo/redo
+//---------------------------------------------------------------------------------
+const GraphJournal & NiceGraph::getJournal()
+{
+	return journal;
+}
+//---------------------------------------------------------------------------------
+bool NiceGraph::canUndo()
+{
+	return journal.canUndo();
+}
+//---------------------------------------------------------------------------------
+bool NiceGraph::canRedo()
+{
+	return journal.canRedo();
+}
+//---------------------------------------------------------------------------------
+bool NiceGraph::undo()
+{
+	return replay(GraphJournal::UNDOING);
+}
+//---------------------------------------------------------------------------------
+bool NiceGraph::redo()
+{
+	return replay(GraphJournal::REDOING);
+}
+//---------------------------------------------------------------------------------
+bool NiceGraph::replay(GraphJournal::MODE mode)
+{
+	// a step is undone by applying the inverse of each change, last first.
+	// The inverses are journaled as usual and become the step on the other
+	// stack, so redoing is undoing them in turn.
+	vector<GraphChange> step;
+	if (!journal.takeStep(mode, step))
+		return false;
+
+	journal.setMode(mode);
+	journal.beginEdit();
+	for (int c = (int) step.size() - 1; c >= 0; c--)
 	{
-		for (int r = 0; r < size; r++)
+		const GraphChange &change = step[c];
+		switch (change.kind)
 		{
-			if (testFromToConnected(q,r))
-				distance[q][r] = getWeight(q,r);
-			else if (q == r)
-				distance[q][r] = 0;		// zero distance to self
-			else
-				distance[q][r] = INT_MAX; // set distance to infinity if not connected directly
-		}
-	} 
-
-	// now iterate over and over to update shortest paths...
-	for (int k = 0; k < size; k++){
-		for (int i = 0; i < size; i++){
-			for (int j = 0; j < size; j++){
-				unsigned int sum = distance[i][k] + distance[k][j];
-				if (sum < distance[i][j]){
-					distance[i][j] = sum; }
-			}
+			case GraphChange::VERTEX_ADDED:		removeVertex(change.id); break;
+			case GraphChange::VERTEX_REMOVED:	restoreVertex(change); break;
+			case GraphChange::EDGE_ADDED:		removeEdge(change.id); break;
+			case GraphChange::EDGE_REMOVED:		restoreEdge(change); break;
+			case GraphChange::NAME_CHANGED:		setVertexName(change.id, change.oldText); break;
+			case GraphChange::COLOR_CHANGED:	setVertexColor(change.id, change.oldColor); break;
+			case GraphChange::VERTEX_ATTRIBUTE_CHANGED:
+				setVertexAttribute(vertexAttributes.findColumn(change.column), change.id, change.oldText); break;
+			case GraphChange::EDGE_ATTRIBUTE_CHANGED:
+				setEdgeAttribute(edgeAttributes.findColumn(change.column), change.id, change.oldText); break;
+			case GraphChange::MADE_UNDIRECTED:	makeDirected(); break;
+			case GraphChange::MADE_DIRECTED:	makeUndirected(); break;
 		}
 	}
-
-
-	// now compute averages for each guy distance matrix
-	
-
-	for (int m = 0; m < size; m++)	{
-		long double sum = 0;
-		for (int n = 0; n < size; n++) {
-			sum += distance[m][n];
-		}
-		sum = sum / (size-1);
-		if (sum >=getNumVertices())
-				sum = -1;
-			paths[m] = sum;
+	journal.endEdit();
+	journal.setMode(GraphJournal::EDITING);
+	return true;
+}
+//---------------------------------------------------------------------------------
+void NiceGraph::restoreVertex(const GraphChange &removed)
+{
+	// back under its old ID, which nothing can have taken since: anything
+	// added after it was removed has already been undone
+	int vertexID = removed.id;
+	Vertex *v = vertexPool.create();
+	vertexList.insertAt(vertexID, v);
+	if (vertexID >= positions.size())
+		positions.resize(vertexID + 1);
+	positions.set(vertexID, removed.x, removed.y, removed.z);
+	v->vID = vertexID;
+	v->vName = names.intern(removed.text);
+	v->vColor = removed.color;
+	vertexAttributes.addRow(vertexID);
+	restoreAttributes(vertexAttributes, vertexID, removed);
+	invalidateSnapshot();
+
+	GraphChange change (GraphChange::VERTEX_ADDED, vertexID);
+	journal.record(change);
+}
+//---------------------------------------------------------------------------------
+void NiceGraph::restoreEdge(const GraphChange &removed)
+{
+	int edgeID = removed.id;
+	Edge *e = edgePool.create();
+	edgeList.insertAt(edgeID, e);
+	e->from = vertexList[removed.from];
+	e->to = vertexList[removed.to];
+	e->eID = edgeID;
+	e->weight = removed.weight;
+	e->from->out[edgeID] = e;
+	e->to->in[edgeID] = e;
+	int fromID = removed.from, toID = removed.to;
+	edgeKey(fromID, toID);
+	edgeIndex.insert(fromID, toID, edgeID);
+	edgeAttributes.addRow(edgeID);
+	restoreAttributes(edgeAttributes, edgeID, removed);
+	invalidateSnapshot();
+	recordEdgeAddition(e);
+}
+//---------------------------------------------------------------------------------
+void NiceGraph::restoreAttributes(AttributeStore &store, int id, const GraphChange &removed)
+{
+	// by name, into whichever of the columns are still there
+	for (unsigned int c = 0; c < removed.row.size(); c++)
+	{
+		int col = store.findColumn(removed.columns[c]);
+		if (col >= 0)
+			store.setText(col, id, removed.row[c]);
 	}
 }
 //---------------------------------------------------------------------------------
-float NiceGraph::avgShortestPathofGraph_FW()
+void NiceGraph::recordEdgeAddition(const Edge *e)
 {
-
-	// this approach based on Floyd-Warshall shortest paths algorithm (iterative!)
-	// returns -1 if the graph if some nodes are not reachable
-
-	int size = vertexList.size();
-
-	unsigned long int  distance[size][size];
-	
-	// initialize all values
-	for (int q = 0; q < size; q++)
+	GraphChange change (GraphChange::EDGE_ADDED, e->eID);
+	change.from = e->from->vID;
+	change.to = e->to->vID;
+	change.weight = e->weight;
+	journal.record(change);
+}
+//---------------------------------------------------------------------------------
+void NiceGraph::recordEdgeRemoval(const Edge *e)
+{
+	// everything restoreEdge() needs
+	GraphChange change (GraphChange::EDGE_REMOVED, e->eID);
+	change.from = e->from->vID;
+	change.to = e->to->vID;
+	change.weight = e->weight;
+	for (int col = 0; col < edgeAttributes.getNumColumns(); col++)
 	{
-		for (int r = 0; r < size; r++)
-		{
-			if (testFromToConnected(q,r))
-				distance[q][r] = getWeight(q,r);
-			else if (q == r)
-				distance[q][r] = 0;		// zero distance to self
-			else
-				distance[q][r] = INT_MAX; // set distance to infinity if not connected directly
-		}
-	} 
-
-	// now iterate over and over to update shortest paths...
-	for (int k = 0; k < size; k++){
-		for (int i = 0; i < size; i++){
-			for (int j = 0; j < size; j++){
-				unsigned int sum = distance[i][k] + distance[k][j];
-				if (sum < distance[i][j]){
-					distance[i][j] = sum; }
-			}
-		}
+		change.row.push_back(edgeAttributes.getText(col, e->eID));
+		change.columns.push_back(edgeAttributes.getColumnName(col));
 	}
+	journal.record(change);
+}
 
+// Graph Analysis
+//---------------------------------------------------------------------------------
+void NiceGraph::avgShortestPathMatrix(map<int,float> &paths )
+{ 
+	// one BFS (or Dijkstra) per vertex, see GraphSnapshot::pathMetrics()
+	// returns -1 for the vertices that can't reach all the others
 
-	// now compute averages using distance matrix
-	long double sum = 0;
-
-	for (int m = 0; m < size; m++)	{
+	const GraphSnapshot &csr = getSnapshot();
+	PathMetrics metrics;
+	csr.pathMetrics(metrics);
 
-		for (int n = 0; n < size; n++) {
-			sum += distance[m][n];
+	for (int m = 0; m < csr.getNumVertices(); m++)
+		paths[csr.getVID(m)] = metrics.avgPath[m];
+}
+//---------------------------------------------------------------------------------
+float NiceGraph::avgShortestPathofGraph_FW()
+{
+	// the name is historical: the all pairs matrix is gone, and both this and
+	// the _BFS version sum one search per source (GraphSnapshot::pathMetrics())
+	// returns -1 if the graph if some nodes are not reachable
 
+	PathMetrics metrics;
+	getSnapshot().pathMetrics(metrics);
 
-		}
-	}
-	float value = (sum / (size * (size - 1)));
-	if (value >= getNumVertices())			// the case where the graph is disconnected
-		value=-1;
-	return value ;		// return the average over all values not including distance to self
+	return metrics.graphAvgPath;	// not including distance to self
 }
 //---------------------------------------------------------------------------------
-// works but is SLOW!! WHY??
 float NiceGraph::avgShortestPathofGraph_BFS()
 {
-	// This approach based on a breadth first search --> better for undirected graphs?
-	int size = vertexList.size();
-
-	unsigned long int  distance[size][size];
-
-	// initialize all values
-	for (int q = 0; q < size; q++)
-	{
-		for (int r = 0; r < size; r++)
-		{
-				distance[q][r] = INT_MAX; // set distance to infinity if not connected directly
-		}
-	} 
-
-	for (int q =0; q < size; q++)
-	{
-		vector<bool> visited (size, false); // initialize all visited values to true so far
-		visited[q] = true; 	// has already visited self
-		distance[q][q] = 0; // distance to self is always zero
-		queue<int> Q;
-		Q.push(q);
-		
-		do {		
-			visited[Q.front()] = true;
-			vector<int> temp = getOutNeighborList(Q.front());
-			if (!temp.empty())
-			{
-				for (unsigned int t = 0; t < temp.size(); t++)
-				{
-					distance[Q.front()][temp[t]] = getWeight(Q.front(),temp[t]);
-					if (!visited[temp[t]])
-						Q.push(temp[t]);
-					unsigned int newPath = distance[q][Q.front()] + distance[Q.front()][temp[t]];
-					if (newPath < distance[q][temp[t]])	{
-						distance[q][temp[t]] = newPath;
-						}
-					
-				}
-			} 
-
-			Q.pop();	// pop off the neighbor just examined
-
-		}  while (!Q.empty());
-	}
-
-	// now compute averages using distance matrix
-	long double sum = 0;
-
-	for (int m = 0; m < size; m++)	{
-		for (int n = 0; n < size; n++) {
-			sum += distance[m][n];
-		}
-	}
-
-	float value = (sum / (size * (size - 1)));
-	if (value >= getNumVertices())			// the case where the graph is disconnected
-		value=-1;
-	return value ;		// return the average over all values not including distance to self
-	
+	return avgShortestPathofGraph_FW();
 }
 //---------------------------------------------------------------------------------
 float NiceGraph::getHomophilicDyadDensity()
@@ -737,10 +1016,10 @@ float NiceGraph::getHomophilicDyadDensity()
 	int same = 0, different = 0;
 
 	
-	for (map<int,Edge*>::iterator iter = edgeList.begin(); iter != edgeList.end(); iter++)
+	for (int iter = edgeList.begin(); iter != edgeList.end(); iter = edgeList.next(iter))
 	{
 		Edge* eTemp;
-		eTemp = iter->second;
+		eTemp = edgeList[iter];
 
 
 		if (eTemp->from->vColor == eTemp->to->vColor)
@@ -754,137 +1033,245 @@ float NiceGraph::getHomophilicDyadDensity()
 	return HDD;
 }
 //------------------------------------------------------------------------------
-void NiceGraph::getPageRank(map<int,float> &pageRank, int iterations, float damping)
+PageRankReport NiceGraph::getPageRank(map<int,float> &pageRank, int maxIterations, float damping, double tolerance)
 {
-	int total = getNumVertices();
-
-	// set initial page ranks
-	for (map<int,Vertex*>::iterator vIter = vertexList.begin(); vIter != vertexList.end(); vIter++)
-	{
-		pageRank[vIter->first] = 1.0/(float)total;
-	}
+	const GraphSnapshot &csr = getSnapshot();
 
-	// run arbitrary number of iterations
-	for (int i = 0; i < iterations; i++)
-	{
-		for (map<int,Vertex*>::iterator vIter = vertexList.begin(); vIter != vertexList.end(); vIter++)
-		{	
-			float votes = 0;
-			int id = vIter->first;
-			
-			vector<int> inList = getInNeighborList(id);
+	vector<float> rank;
+	PageRankReport report = csr.pageRank(rank, damping, tolerance, maxIterations);
 
-			for (vector<int>::iterator nIter = inList.begin(); nIter != inList.end(); nIter++)
-			{
-				votes+=pageRank[(*nIter)]/(float)getOutDegree(*nIter);
-			}
+	for (int v = 0; v < csr.getNumVertices(); v++)
+		pageRank[csr.getVID(v)] = rank[v];
 
-			pageRank[id] = (1.0-damping) + damping * votes;
-		}
-	}
+	return report;
 }
 //------------------------------------------------------------------------------
 float NiceGraph::getClusteringCoefficient(int index)
 {
+	const GraphSnapshot &csr = getSnapshot();
+	int v = csr.getDenseIndex(index);
 
-	vector<int> ns = getNeighborList(index);
+	if (v < 0)
+		return 0;	// no such vertex
 
-	int size = ns.size();
+	return csr.clusteringCoefficient(v);
+}
+//------------------------------------------------------------------------------
+void NiceGraph::getClusteringMetrics(ClusteringMetrics &metrics)
+{
+	getSnapshot().clusteringMetrics(metrics);
+}
+//------------------------------------------------------------------------------
+void NiceGraph::getClosenessCentrality(map<int,float> &cCentrality)
+{
+	// see GraphSnapshot::pathMetrics()
 
-	int max = size * (size - 1) ;
-	
-	int cnxs = 0;
+	const GraphSnapshot &csr = getSnapshot();
+	PathMetrics metrics;
+	csr.pathMetrics(metrics);
 
-	float cc = 0;
+	for (int m = 0; m < csr.getNumVertices(); m++)
+		cCentrality[csr.getVID(m)] = metrics.closeness[m];
+}
+//------------------------------------------------------------------------------
+void NiceGraph::getPathMetrics(PathMetrics &metrics)
+{
+	if (!getSnapshot().pathMetrics(metrics))
+		cout << "ERROR: Shortest paths need edge weights of 0 or more" << endl;
+}
+//------------------------------------------------------------------------------
+void NiceGraph::estimatePathMetrics(PathEstimate &estimate, int pivots, float targetError)
+{
+	getSnapshot().estimatePathMetrics(estimate, pivots, targetError);
+}
+//------------------------------------------------------------------------------
+void NiceGraph::getRelatedVertices(int index, int k, vector<pair<int,float> > &related)
+{
+	vector<int> indices (1, index);
+	getRelatedVertices(indices, k, related);
+}
+//------------------------------------------------------------------------------
+void NiceGraph::getRelatedVertices(const vector<int> &indices, int k, vector<pair<int,float> > &related)
+{
+	const GraphSnapshot &csr = getSnapshot();
 
-	for (int i = 0; i < size; i++)
+	vector<int> seeds;
+	for (unsigned int i = 0; i < indices.size(); i++)
 	{
-		for (int j = 0; j < size; j++)
-		{
-			int from = ns[i];
-			int to = ns[j];
-			if (from!=to)	// don't connect to self
-			{
-				if (testFromToConnected(from,to)) cnxs++;
-			}
-		}
+		int v = csr.getDenseIndex(indices[i]);
+		if (v >= 0)
+			seeds.push_back(v);		// skip anything that isn't a vertex
 	}
-	if (max<1)
-		cc = 0;
-	else
-		cc = (float)cnxs / (float)max;
 
-	return cc;
+	relatedRank.query(csr, seeds, k, related);
+	for (unsigned int r = 0; r < related.size(); r++)
+		related[r].first = csr.getVID(related[r].first);
 }
 //------------------------------------------------------------------------------
-void NiceGraph::getClosenessCentrality(map<int,float> &cCentrality)
+const GraphSnapshot & NiceGraph::getSnapshot()
 {
-	// this approach based on Floyd-Warshall shortest paths algorithm (iterative!)
-	// almost the same as avg shortest paths, but only calculates against reachable vertices
-	// therefore always returns a normal value even if the graph is partially disconnected
+	if (!snapshot)
+		buildSnapshot();
 
-	unsigned int size = vertexList.size();
+	return *snapshot;
+}
+//------------------------------------------------------------------------------
+shared_ptr<const GraphSnapshot> NiceGraph::shareSnapshot()
+{
+	if (!snapshot)
+		buildSnapshot();
 
-	unsigned long int  distance[size][size];
-	
-	// initialize all values
-	for (unsigned int q = 0; q < size; q++)
+	return snapshot;
+}
+//------------------------------------------------------------------------------
+unsigned long NiceGraph::getVersion()
+{
+	return version;
+}
+//------------------------------------------------------------------------------
+void NiceGraph::nextVersion()
+{
+	// versions are drawn from one counter shared by all graphs, so a result
+	// tagged with a version can't be mistaken for one from a graph that was
+	// loaded in its place
+	static unsigned long lastVersion = 0;
+	version = ++lastVersion;
+}
+//------------------------------------------------------------------------------
+void NiceGraph::invalidateSnapshot()
+{
+	// called by everything that changes the structure of the graph; anyone
+	// still holding the old snapshot keeps it, the next request builds a new one
+	snapshot.reset();
+	nextVersion();
+}
+//------------------------------------------------------------------------------
+void NiceGraph::buildSnapshot()
+{
+	shared_ptr<GraphSnapshot> built(new GraphSnapshot());
+	GraphSnapshot &snap = *built;
+	snap.version = version;
+
+	// dense indices are handed out in the order chosen by reorder(), then in
+	// increasing vID order for everything it didn't place
+	snap.vidToDense.assign(vertexList.idLimit(), -1);
+	snap.denseToVID.reserve(vertexList.size());
+	snap.denseGeneration.reserve(vertexList.size());
+	for (unsigned int o = 0; o < vertexOrder.size(); o++)
 	{
-		for (unsigned int r = 0; r < size; r++)
+		int vID = vertexOrder[o];
+		if (validVID(vID) && (snap.vidToDense[vID] < 0))
 		{
-			if (testFromToConnected(q,r))
-				distance[q][r] = getWeight(q,r);
-			else if (q == r)
-				distance[q][r] = 0;		// zero distance to self
-			else
-				distance[q][r] = INT_MAX; // set distance to infinity if not connected directly
+			snap.vidToDense[vID] = snap.denseToVID.size();
+			snap.denseToVID.push_back(vID);
+			snap.denseGeneration.push_back(vertexList.generation(vID));
 		}
-	} 
-
-	// now iterate over and over to update shortest paths...
-	for (unsigned int k = 0; k < size; k++){
-		for (unsigned int i = 0; i < size; i++){
-			for (unsigned int j = 0; j < size; j++){
-				unsigned int sum = distance[i][k] + distance[k][j];
-				if (sum < distance[i][j]){
-					distance[i][j] = sum; }
-			}
+	}
+	for (int iter = vertexList.begin(); iter != vertexList.end(); iter = vertexList.next(iter))
+	{
+		if (snap.vidToDense[iter] < 0)
+		{
+			snap.vidToDense[iter] = snap.denseToVID.size();
+			snap.denseToVID.push_back(iter);
+			snap.denseGeneration.push_back(vertexList.generation(iter));
 		}
 	}
 
+	snap.outNeighbors.reserve(edgeList.size());
+	snap.outWeight.reserve(edgeList.size());
+	snap.inNeighbors.reserve(edgeList.size());
 
-	// now compute averages for each guy distance matrix
-	
-	for (unsigned int m = 0; m < size; m++)	{
-		long double sum = 0;
-		int reachable = 0;
-		for (unsigned int n = 0; n < size; n++) {
-			if (distance[m][n] < size) // ie. if the vertex is reachable
-			{
-			sum += distance[m][n];	reachable++;}
+	// fill one row at a time, sorting each row by dense neighbor index
+	vector<pair<int,float> > row;
+	vector<int> inRow;
+	for (unsigned int d = 0; d < snap.denseToVID.size(); d++)
+	{
+		int iter = snap.denseToVID[d];
+		row.clear();
+		NeighborRange outs = getOutNeighbors(iter);
+		for (NeighborRange::iterator n = outs.begin(); n != outs.end(); ++n)
+			row.push_back(make_pair(snap.vidToDense[*n], n.edge()->weight));
+		sort(row.begin(), row.end());
+		for (unsigned int r = 0; r < row.size(); r++)
+		{
+			snap.outNeighbors.push_back(row[r].first);
+			snap.outWeight.push_back(row[r].second);
 		}
-		if (!(reachable == 1)) // ie can only get to itself
-			sum = sum / (reachable-1);
-		else 	sum = 0;
-		if (sum >=getNumVertices())		// should never happen here
-				sum = -1;
-			cCentrality[m] = sum;
+		snap.outOffsets.push_back(snap.outNeighbors.size());
+
+		inRow.clear();
+		NeighborRange ins = getInNeighbors(iter);
+		for (NeighborRange::iterator n = ins.begin(); n != ins.end(); ++n)
+			inRow.push_back(snap.vidToDense[*n]);
+		sort(inRow.begin(), inRow.end());
+		snap.inNeighbors.insert(snap.inNeighbors.end(), inRow.begin(), inRow.end());
+		snap.inOffsets.push_back(snap.inNeighbors.size());
+	}
+
+	// dense graphs get the bit matrix too, for the word-parallel kernels
+	if (BitMatrix::worthBuilding(snap.getNumVertices(), snap.getNumEdges()))
+		snap.bits.build(snap);
+	if (compressedRows)
+		snap.packed.build(snap);
+
+	snapshot = built;
+}
+//------------------------------------------------------------------------------
+void NiceGraph::reorder(int strategy)
+{
+	// the new order is worked out on the snapshot as it is now, then kept as a
+	// list of vertex IDs so later snapshots follow it too
+	const GraphSnapshot &csr = getSnapshot();
+	vector<int> dense;
+
+	switch (strategy)
+	{
+		case RCM_ORDER:		csr.rcmOrder(dense); break;
+		case DEGREE_ORDER:	csr.degreeOrder(dense); break;
+		case GORDER:		csr.gorderOrder(dense); break;
+		default:			break;	// ID_ORDER, back to increasing IDs
 	}
+
+	vertexOrder.resize(dense.size());
+	for (unsigned int d = 0; d < dense.size(); d++)
+		vertexOrder[d] = csr.getVID(dense[d]);
+
+	// same graph, so the version stays; only the layout of the snapshot changes
+	snapshot.reset();
+}
+//------------------------------------------------------------------------------
+void NiceGraph::setCompressedRows(bool on)
+{
+	// the results come out the same either way, so the version stays
+	if (on != compressedRows)
+		snapshot.reset();
+	compressedRows = on;
+}
+//------------------------------------------------------------------------------
+bool NiceGraph::getCompressedRows()
+{
+	return compressedRows;
+}
+//------------------------------------------------------------------------------
+void NiceGraph::getVertexOrder(vector<int> &order)
+{
+	const GraphSnapshot &csr = getSnapshot();
+	order.resize(csr.getNumVertices());
+	for (int d = 0; d < csr.getNumVertices(); d++)
+		order[d] = csr.getVID(d);
 }
 //------------------------------------------------------------------------------
 void NiceGraph::setXYZPos(int vertexID, float x, float y, float z)
 {
-	vertexList[vertexID]->posX = x;
-	vertexList[vertexID]->posY = y;
-	vertexList[vertexID]->posZ = z;
+	positions.set(vertexID, x, y, z);
 }
 //------------------------------------------------------------------------------
 // takes a reference to 3-vector and returns it full of coordinates
 void NiceGraph::getXYZPos(int vertexID, vector<float> & xyz) 	
 {
-	xyz[0]= vertexList[vertexID]->posX;
-	xyz[1]= vertexList[vertexID]->posY;
-	xyz[2]= vertexList[vertexID]->posZ;
+	xyz[0]= positions.xData()[vertexID];
+	xyz[1]= positions.yData()[vertexID];
+	xyz[2]= positions.zData()[vertexID];
 }
 //---------------------------------------------------------------------------------
 // return endpoints of an edge
@@ -892,22 +1279,40 @@ void NiceGraph::getEndpoints (int edgeID, vector<float> & v1, vector<float> &v2)
 {
 	if (validEID(edgeID))
 	{
-		Vertex *vert1 = edgeList[edgeID]->from;
-		Vertex *vert2 = edgeList[edgeID]->to;
-
-		v1[0] = vert1->posX;
-		v1[1] = vert1->posY;
-		v1[2] = vert1->posZ;
-
-		v2[0] = vert2->posX;
-		v2[1] = vert2->posY;
-		v2[2] = vert2->posZ;
+		getXYZPos(edgeList[edgeID]->from->vID, v1);
+		getXYZPos(edgeList[edgeID]->to->vID, v2);
 	}
 }
 //---------------------------------------------------------------------------------
+void NiceGraph::getEdgeVertices (int edgeID, int &from, int &to)
+{
+	from = edgeList[edgeID]->from->vID;
+	to = edgeList[edgeID]->to->vID;
+}
+//---------------------------------------------------------------------------------
+int NiceGraph::getVertexIDLimit()
+{
+	return vertexList.idLimit();
+}
+//---------------------------------------------------------------------------------
+float * NiceGraph::getXPositions()
+{
+	return positions.xData();
+}
+//---------------------------------------------------------------------------------
+float * NiceGraph::getYPositions()
+{
+	return positions.yData();
+}
+//---------------------------------------------------------------------------------
+float * NiceGraph::getZPositions()
+{
+	return positions.zData();
+}
+//---------------------------------------------------------------------------------
 void NiceGraph::randomLayoutAll(float xmin, float xmax, float ymin, float ymax, float zmin, float zmax)
 {
-	for (unsigned int vIndex = 0; vIndex < vertexList.size(); vIndex++)
+	for (int vIndex = vertexList.begin(); vIndex != vertexList.end(); vIndex = vertexList.next(vIndex))
 	{
 		randomLayout (vIndex, xmin, xmax, ymin, ymax, zmin, zmax);
 	}
@@ -935,18 +1340,17 @@ void NiceGraph::selfOrganize(float force, float min, float max)
 
 		// iterate over edges, attract and check bounds, rearrange as necessary
 
-	for (map<int,Edge*>::iterator iter = edgeList.begin(); iter != edgeList.end(); iter++)
+	float *X = positions.xData(), *Y = positions.yData(), *Z = positions.zData();
+
+	for (int iter = edgeList.begin(); iter != edgeList.end(); iter = edgeList.next(iter))
 	{
-		int e = iter->first;
-		vector<float> v1 (3), v2 (3);
 		float attraction = 0, dx = 0, dy = 0, dz = 0;
-		int id1 = edgeList[e]->from->vID;
-		int id2 = edgeList[e]->to->vID;
-		getEndpoints (e, v1, v2);
+		int id1, id2;
+		getEdgeVertices (iter, id1, id2);
 
-		float vx = v2[0] - v1[0];
-		float vy = v2[1] - v1[1];
-		float vz = v2[2] - v1[2];
+		float vx = X[id2] - X[id1];
+		float vy = Y[id2] - Y[id1];
+		float vz = Z[id2] - Z[id1];
 		
 		float dr = sqrt ( vx*vx + vy*vy + vz*vz );
 
@@ -958,44 +1362,53 @@ void NiceGraph::selfOrganize(float force, float min, float max)
 
 		float scale = 1.0;
 
-		setXYZPos (id1, v1[0] + scale * dx, v1[1] + scale * dy, v1[2] + scale * dz);		
-		setXYZPos (id2, v2[0] - scale * dx, v2[1] - scale * dy, v2[2] - scale * dz);
-
+		X[id1] += scale * dx; Y[id1] += scale * dy; Z[id1] += scale * dz;
+		X[id2] -= scale * dx; Y[id2] -= scale * dy; Z[id2] -= scale * dz;
 	}
 
-	for (map<int,Vertex*>::iterator iter = vertexList.begin(); iter != vertexList.end(); iter++)
+	// weight 1 for live vertices and 0 for unused IDs, so the repulsion loop
+	// can run straight down the coordinate arrays without branching
+	int limit = vertexList.idLimit();
+	vector<float> live (limit, 0);
+	for (int iter = vertexList.begin(); iter != vertexList.end(); iter = vertexList.next(iter))
+		live[iter] = 1;
+
+	for (int iter = vertexList.begin(); iter != vertexList.end(); iter = vertexList.next(iter))
 	{
-		int self = iter->first;
+		int self = iter;
 
 		float dx = 0, dy = 0, dz = 0, repulsion = 0;
-		float px = vertexList[self]->posX;
-		float py = vertexList[self]->posY;
-		float pz = vertexList[self]->posZ;
+		float px = X[self];
+		float py = Y[self];
+		float pz = Z[self];
+
+		live[self] = 0;		// don't need to repel self, too!
 
 		// sum repulsion from other vertices
-		for (map<int,Vertex*>::iterator iter2 = vertexList.begin(); iter2 != vertexList.end(); iter2++)
+		for (int other = 0; other < limit; other++)
 		{
-			int other = iter2->first;
-			if (self == other)		// don't need to repel self, too!
-				continue;
-			
-			float vx = vertexList[other]->posX - px;
-			float vy = vertexList[other]->posY - py;
-			float vz = vertexList[other]->posZ - pz;
+			float vx = X[other] - px;
+			float vy = Y[other] - py;
+			float vz = Z[other] - pz;
 
-			float dr = sqrt (vx * vx + vy * vy + vz * vz);
+			// a zero weight also moves the distance away from zero
+			float dr = sqrt (vx * vx + vy * vy + vz * vz + (1 - live[other]));
 
 			// let the repulsion go as 1/r^2, like the electrostatic force
 
-			repulsion = -0.01 * force*force / (sqrt(dr) * dr);
+			repulsion = -0.01 * force*force * live[other] / (sqrt(dr) * dr);
 			
 			dx += repulsion * vx;
 			dy += repulsion * vy;
 			dz += repulsion * vz;
 		}
 
+		live[self] = 1;
+
 		// update position
-			setXYZPos (self, px + dx, py + dy, pz + dz);
+		X[self] = px + dx;
+		Y[self] = py + dy;
+		Z[self] = pz + dz;
 	}
 }
 //------------------------------------------------------------------------------
@@ -1010,7 +1423,7 @@ void NiceGraph::sphereLayout(float radius)
 	int theta_total = ceil( sqrt (num));
 	int phi_total =  ceil( sqrt (num));
 
-	map<int,Vertex*>::iterator iter = vertexList.begin();
+	int iter = vertexList.begin();
 
 	for (int theta_steps = 0; theta_steps < theta_total; theta_steps++)
 	{
@@ -1018,7 +1431,7 @@ void NiceGraph::sphereLayout(float radius)
 		{
 			if (iter != vertexList.end())
 			{
-				int n = iter->first;
+				int n = iter;
 				
 				phi += d_phi;
 	
@@ -1026,7 +1439,7 @@ void NiceGraph::sphereLayout(float radius)
 				y = radius * sin (theta) * sin (phi);
 				z = radius * cos (theta);
 				setXYZPos(n,x,y,z);
-				iter++;
+				iter = vertexList.next(iter);
 			}
 		}
 		theta += d_theta;
@@ -1038,9 +1451,9 @@ void NiceGraph::circleLayout(float radius)
 	float x, y, angle;
 	float interval = 2.0 * 3.14159265 / getNumVertices(); 
 
-	for (map<int,Vertex*>::iterator iter = vertexList.begin(); iter != vertexList.end(); iter++)
+	for (int iter = vertexList.begin(); iter != vertexList.end(); iter = vertexList.next(iter))
 	{
-		int index = iter->first;
+		int index = iter;
 		angle = interval * index;
 		x = radius * cos (angle);
 		y = radius * sin (angle);	
@@ -1056,9 +1469,9 @@ void NiceGraph::spiralLayout(float radius)
 	float radIncrement = radius / (1.1 * getNumVertices());
 	float zIncrement = 2.0 * radius / getNumVertices();
 
-	for (map<int,Vertex*>::iterator iter = vertexList.begin(); iter != vertexList.end(); iter++)
+	for (int iter = vertexList.begin(); iter != vertexList.end(); iter = vertexList.next(iter))
 	{
-		int index = iter->first;
+		int index = iter;
 		angle = interval * index;
 		x = index * radIncrement * cos (angle);
 		y = index * radIncrement * sin (angle);	
@@ -1074,9 +1487,9 @@ void NiceGraph::layersByGroupLayout(float radius, float nodeSize)
 	float yStep = 2 * xStep;
 
 	// first count how many are in each group for each one
-	for (map<int,Vertex*>::iterator iter = vertexList.begin(); iter != vertexList.end(); iter++)
+	for (int iter = vertexList.begin(); iter != vertexList.end(); iter = vertexList.next(iter))
 	{
-		int group = getVertexColor(iter->first);
+		int group = getVertexColor(iter);
 		switch (group)
 		{
 			case 0:count[0]++;break;
@@ -1094,10 +1507,10 @@ void NiceGraph::layersByGroupLayout(float radius, float nodeSize)
 	}
 
 	// now set the plotting points
-	for (map<int,Vertex*>::iterator iter = vertexList.begin(); iter != vertexList.end(); iter++)
+	for (int iter = vertexList.begin(); iter != vertexList.end(); iter = vertexList.next(iter))
 	{
 		// set position for this vertex
-		int v = iter->first;
+		int v = iter;
 		int group = getVertexColor(v);
 		float x = last[group];
 		float y = group * yStep;
@@ -1130,82 +1543,76 @@ void NiceGraph::fruchtermanReingoldLayout(float xmin, float xmax, float ymin, fl
 	zone = zone;
 	float t = zone;		// arbitrary initial temperature
 	
+	float *X = positions.xData(), *Y = positions.yData(), *Z = positions.zData();
+
+	// weight 1 for live vertices and 0 for unused IDs (see selfOrganize)
+	int limit = vertexList.idLimit();
+	vector<float> live (limit, 0);
+	for (int V = vertexList.begin(); V != vertexList.end(); V = vertexList.next(V))
+		live[V] = 1;
+
 	// do some arbitrary number of iterations
 	for (int i = 0; i < iterations; i++)
 	{
-		map<int,float> dx,dy,dz; // store displacements by vertex ID until the end
+		vector<float> dx (limit, 0), dy (limit, 0), dz (limit, 0); // store displacements by vertex ID until the end
 		
 		//calculate repulsive forces
-		for (map<int,Vertex*>::iterator pU = vertexList.begin(); pU != vertexList.end(); pU++)
+		for (int pU = vertexList.begin(); pU != vertexList.end(); pU = vertexList.next(pU))
 		{	// initialize values
-			int u_id = pU->first;
-			vector<float> u_pos(3);
-			getXYZPos (u_id, u_pos);
-			for (map<int,Vertex*>::iterator pV = vertexList.begin(); pV != vertexList.end(); pV++)
+			int u_id = pU;
+			float ux = X[u_id], uy = Y[u_id], uz = Z[u_id];
+			float sumx = 0, sumy = 0, sumz = 0;
+			for (int pV = 0; pV < limit; pV++)
 			{
-				vector<float> v_pos(3);
-				getXYZPos(pV->first, v_pos);
-				float diffx =	v_pos[0]-u_pos[0];
-				float diffy =   v_pos[1]-u_pos[1];
-				float diffz =   v_pos[2]-u_pos[2];
+				float diffx =	X[pV]-ux;
+				float diffy =   Y[pV]-uy;
+				float diffz =   Z[pV]-uz;
 				float dr = sqrt (diffx*diffx+diffy*diffy+diffz*diffz);		
-				if (dr < zone)	// only do the calculations if U is within the zone of V
-				{
-					float force_r = 0;
-					float scale = 0;
-					if (dr == 0)
-					{
-						force_r = -100;
-						scale = 1;
-					}
-					else
-					{
-						force_r = -1.0*(k * k)/dr; 
-						scale = dr;
-					}
-					dx[u_id] += force_r * diffx/scale ;
-					dy[u_id] += force_r * diffy/scale ;
-					dz[u_id] += force_r * diffz/scale ;
-				}
+				// only count V if it is a vertex and U is within its zone
+				float weight = (dr < zone) ? live[pV] : 0;
+				float force_r = (dr == 0) ? -100 : -1.0*(k * k)/dr;
+				float scale = (dr == 0) ? 1 : dr;
+				sumx += weight * force_r * diffx/scale ;
+				sumy += weight * force_r * diffy/scale ;
+				sumz += weight * force_r * diffz/scale ;
 			}
+			dx[u_id] = sumx;
+			dy[u_id] = sumy;
+			dz[u_id] = sumz;
 		}
 		
 		// calculate attractive forces
-		for (map<int,Edge*>::iterator pE = edgeList.begin(); pE != edgeList.end(); pE++)
+		for (int pE = edgeList.begin(); pE != edgeList.end(); pE = edgeList.next(pE))
 		{
-			vector<float> u_pos(3), v_pos(3);
-			getEndpoints(pE->first, u_pos, v_pos);
-			float diffx =	v_pos[0]-u_pos[0];
-			float diffy =   v_pos[1]-u_pos[1];
-			float diffz =   v_pos[2]-u_pos[2];
+			int from, to;
+			getEdgeVertices(pE, from, to);
+			float diffx =	X[to]-X[from];
+			float diffy =   Y[to]-Y[from];
+			float diffz =   Z[to]-Z[from];
 			float dr = sqrt (diffx*diffx + diffy*diffy + diffz*diffz);	
 
 			float force_a = (dr*dr)/k;
 			float scale = dr;
 			if (dr ==0) scale = -1.0;
-			dx[pE->second->from->vID] += force_a * diffx/scale ;
-			dy[pE->second->from->vID] += force_a * diffy/scale ;
-			dz[pE->second->from->vID] += force_a * diffz/scale ;
-			dx[pE->second->to->vID] += -1.0 * force_a * diffx/scale ;
-			dy[pE->second->to->vID] += -1.0 * force_a * diffy/scale ;
-			dz[pE->second->to->vID] += -1.0 * force_a * diffz/scale ;
+			dx[from] += force_a * diffx/scale ;
+			dy[from] += force_a * diffy/scale ;
+			dz[from] += force_a * diffz/scale ;
+			dx[to] += -1.0 * force_a * diffx/scale ;
+			dy[to] += -1.0 * force_a * diffy/scale ;
+			dz[to] += -1.0 * force_a * diffz/scale ;
 		}
 	
 		// now do bounds checking and update all the positions
-		for (map<int,Vertex*>::iterator V = vertexList.begin(); V != vertexList.end(); V++)
+		for (int V = vertexList.begin(); V != vertexList.end(); V = vertexList.next(V))
 		{
-			int id = V->first;
-			vector<float> p(3);
-			getXYZPos(id,p);
-			p[0] += min (dx[id],t);
-			p[1] += min (dy[id],t);			
-			p[2] += min (dz[id],t);			
+			int id = V;
+			float px = X[id] + min (dx[id],t);
+			float py = Y[id] + min (dy[id],t);			
+			float pz = Z[id] + min (dz[id],t);			
 			// also do bounds checking on frame??
-			p[0] = min(xmax,max(xmin,p[0]));
-			p[1] = min(ymax,max(ymin,p[1]));
-			p[2] = min(zmax,max(zmin,p[2]));
-			
-			setXYZPos(id, p[0], p[1], p[2]);
+			X[id] = min(xmax,max(xmin,px));
+			Y[id] = min(ymax,max(ymin,py));
+			Z[id] = min(zmax,max(zmin,pz));
 		}
 		// now cool the temperature a bit
 		t*=.98;
@@ -1214,55 +1621,55 @@ void NiceGraph::fruchtermanReingoldLayout(float xmin, float xmax, float ymin, fl
 //------------------------------------------------------------------------------
 bool NiceGraph::validVID(int index)
 {
-	// find the vertex id
-	for (map<int,Vertex*>::iterator iter = vertexList.begin(); iter != vertexList.end(); iter++)
-	{
-		if (iter->first == index)
-			return true;	// found the index, return true, is valid
-	}
-
-	return false; // didn't find it, not valid
+	return vertexList.valid(index);
 }
 //------------------------------------------------------------------------------
 bool NiceGraph::validEID(int index)
 {
-	// find the vertex id
-	for (map<int,Edge*>::iterator iter = edgeList.begin(); iter != edgeList.end(); iter++)
-	{
-		if (iter->first == index)
-			return true;	// found the index, return true, is valid
-	}
-	return false; // didn't find it, not valid
+	return edgeList.valid(index);
+}
+//------------------------------------------------------------------------------
+unsigned int NiceGraph::getVertexGeneration(int vertexID)
+{
+	return vertexList.generation(vertexID);
 }
 //------------------------------------------------------------------------------
 void NiceGraph::getEdgeIndexList(vector<int> &list)
 {
 	// run through the edge id list
-	for (map<int,Edge*>::iterator iter = edgeList.begin(); iter != edgeList.end(); iter++)
+	for (int iter = edgeList.begin(); iter != edgeList.end(); iter = edgeList.next(iter))
 	{
-		list.push_back(iter->first);
+		list.push_back(iter);
 	}
 }
 //------------------------------------------------------------------------------
 void NiceGraph::getVertexIndexList(vector<int> &list)
 {
 	// run through the vertex id list
-	for (map<int,Vertex*>::iterator iter = vertexList.begin(); iter != vertexList.end(); iter++)
+	for (int iter = vertexList.begin(); iter != vertexList.end(); iter = vertexList.next(iter))
 	{
-		list.push_back(iter->first);
+		list.push_back(iter);
 	}
 }
+//------------------------------------------------------------------------------
+void NiceGraph::getIncidentEdges(int vertexID, vector<int> & list)
+{
+	Vertex *v = vertexList[vertexID];
+	list.reserve(list.size() + v->in.size() + v->out.size());
+
+	for (map<int,Edge*>::iterator iter = v->out.begin(); iter != v->out.end(); iter++)
+		list.push_back(iter->first);
+	for (map<int,Edge*>::iterator iter = v->in.begin(); iter != v->in.end(); iter++)
+		list.push_back(iter->first);
+}
 // file operations
 //------------------------------------------------------------------------------
 void NiceGraph::loadFromFile(string filename)
 {
 	// NB. For loading edited text files, vertex IDs must be unique, but names need not be
 	// NB. Loading from a file will automatically clear what is already there, so beware
-	vertexList.clear();
-	edgeList.clear();
+	clearStorage();
 	isDirected = true;
-	edgeIDCounter = 0;
-	vertexIDCounter = 0;
 
 	// now get the file info
 	ifstream inputStream (filename.c_str());
@@ -1285,44 +1692,110 @@ void NiceGraph::loadFromFile(string filename)
 			else
 			{	
 				int v_id = atoi(tokens[0].c_str());
-				vertexList[v_id] = new Vertex();
+				vertexList.insertAt(v_id, vertexPool.create());
+				if (v_id >= positions.size())
+					positions.resize(v_id + 1);
 				vertexList[v_id]->vID = v_id;
 				vertexList[v_id]->vColor = atoi(tokens[1].c_str());
-				vertexList[v_id]->vName = tokens[2];
+				vertexList[v_id]->vName = names.intern(tokens[2]);
+				vertexAttributes.addRow(v_id);
 				setXYZPos(v_id, atof(tokens[3].c_str()), atof(tokens[4].c_str()), atof(tokens[5].c_str()));
-				vertexIDCounter = std::max(vertexIDCounter, v_id);			
 			}
 			getline(inputStream, nextLine);	
 		}
+		if (nextLine.substr(0,17) == "#EDGES UNDIRECTED")
+			isDirected = false;
 	}
 	else
 		cout << "Error: Can't find #VERTICES to begin parsing file" << endl;
 
-	// now go though the edges
-	while (getline(inputStream, nextLine))
+	// now go though the edges, reading them all first so the storage can be
+	// sized once.  They run up to the first attribute section, if any
+	vector<int> e_ids, from_ids, to_ids;
+	vector<float> e_weights;
+	while (getline(inputStream, nextLine) && (nextLine.substr(0,1) != "#"))
 	{		
 		vector<string> tokens;
 		tokenize (nextLine, tokens, delims);
 		if (tokens.size() != 4)
 			cout << "ERROR: Wrong number of entries for edge, has " << tokens.size() << endl;
+		else if (!validVID(atoi(tokens[1].c_str())) || !validVID(atoi(tokens[2].c_str())))
+			cout << "ERROR: Edge " << tokens[0] << " refers to a missing vertex" << endl;
 		else
 		{
-			int e_id = atoi (tokens[0].c_str());
-			int from_id = atoi (tokens[1].c_str());
-			int to_id = atoi (tokens[2].c_str());
-			edgeList[e_id] = new Edge();
-			edgeList[e_id]->eID = e_id;
-			edgeList[e_id]->from = vertexList[from_id];
-			edgeList[e_id]->to = vertexList[to_id];
-			edgeList[e_id]->weight = atof(tokens[3].c_str());
-			vertexList[from_id]->out[e_id] = edgeList[e_id];
-			vertexList[to_id]->in[e_id] = edgeList[e_id];
-			edgeIDCounter = std::max(edgeIDCounter,e_id);
+			e_ids.push_back(atoi (tokens[0].c_str()));
+			from_ids.push_back(atoi (tokens[1].c_str()));
+			to_ids.push_back(atoi (tokens[2].c_str()));
+			e_weights.push_back(atof(tokens[3].c_str()));
+		}
+	}
+
+	edgeList.reserve(e_ids.size());
+	edgeIndex.reserve(e_ids.size());
+
+	for (unsigned int e = 0; e < e_ids.size(); e++)
+	{
+		int e_id = e_ids[e];
+		if (validEID(e_id))
+		{
+			cout << "ERROR: Edge ID " << e_id << " is used more than once" << endl;
+			continue;
+		}
+		if (testFromToConnected(from_ids[e], to_ids[e]))
+		{
+			cout << "ERROR: Edge " << e_id << " repeats an existing connection" << endl;
+			continue;
+		}
+		Vertex *vFrom = vertexList[from_ids[e]];
+		Vertex *vTo = vertexList[to_ids[e]];
+		Edge *newEdge = edgePool.create();
+		edgeList.insertAt(e_id, newEdge);
+		newEdge->eID = e_id;
+		newEdge->from = vFrom;
+		newEdge->to = vTo;
+		newEdge->weight = e_weights[e];
+		// saved files list the edges in ID order, so hint the inserts at the end
+		vFrom->out.insert(vFrom->out.end(), make_pair(e_id, newEdge));
+		vTo->in.insert(vTo->in.end(), make_pair(e_id, newEdge));
+		int key1 = from_ids[e], key2 = to_ids[e];
+		edgeKey(key1, key2);
+		edgeIndex.insert(key1, key2, e_id);
+		edgeAttributes.addRow(e_id);
+	}
+
+	// finally the attribute columns, "#VATTR <type> <name>" or "#EATTR <type> <name>"
+	// followed by "id,value" lines
+	while (inputStream && (nextLine.substr(0,1) == "#"))
+	{
+		bool forVertices = (nextLine.substr(0,6) == "#VATTR");
+		AttributeStore &store = forVertices ? vertexAttributes : edgeAttributes;
+		string::size_type typeEnd = nextLine.find(' ', 7);
+		AttributeStore::Type type;
+		int col = -1;
+		if ((forVertices || (nextLine.substr(0,6) == "#EATTR")) && (typeEnd != string::npos)
+			&& AttributeStore::parseType(nextLine.substr(7, typeEnd - 7), type))
+			col = store.addColumn(nextLine.substr(typeEnd + 1), type);
+		if (col < 0)
+			cout << "ERROR: Can't read attribute section " << nextLine << endl;
+
+		while (getline(inputStream, nextLine) && (nextLine.substr(0,1) != "#"))
+		{
+			if (col < 0)
+				continue;
+			// everything after the first comma is the value, so strings may hold commas
+			string::size_type comma = nextLine.find(',');
+			int id = atoi(nextLine.substr(0, comma).c_str());
+			if ((comma == string::npos) || !store.isLive(id))
+				cout << "ERROR: Attribute value for missing ID " << id << endl;
+			else
+				store.setText(col, id, AttributeStore::unescape(nextLine.substr(comma + 1)));
 		}
 	}
 	inputStream.close();
-	edgeIDCounter++;
-	vertexIDCounter++;
+
+	// a loaded graph starts with no history, and cursors into the old one
+	// are no longer good
+	journal.reset();
 }
 //---------------------------------------------------------------------------------
 void NiceGraph::saveToFile(string filename)
@@ -1331,22 +1804,87 @@ void NiceGraph::saveToFile(string filename)
 		
 	outFile << "#VERTICES\n";
 	// output the vertices
-	for (map<int,Vertex*>::iterator iter = vertexList.begin(); iter != vertexList.end(); iter++)
+	for (int iter = vertexList.begin(); iter != vertexList.end(); iter = vertexList.next(iter))
 	{
-		outFile << iter->first << "," << iter->second->vColor << "," << iter->second->vName << ","
-		<< iter->second->posX << "," << iter->second->posY << "," << iter->second->posZ << "\n";
+		outFile << iter << "," << vertexList[iter]->vColor << "," << names.c_str(vertexList[iter]->vName) << ","
+		<< positions.xData()[iter] << "," << positions.yData()[iter] << "," << positions.zData()[iter] << "\n";
 	}
-	outFile << "#EDGES\n";
+	// undirected graphs still list each edge once, in its stored direction
+	outFile << (isDirected ? "#EDGES\n" : "#EDGES UNDIRECTED\n");
 	// run through the edge id list
-	for (map<int,Edge*>::iterator iter = edgeList.begin(); iter != edgeList.end(); iter++)
+	for (int iter = edgeList.begin(); iter != edgeList.end(); iter = edgeList.next(iter))
 	{
-		Edge* pEdge = iter->second;
-		outFile << iter->first << "," << pEdge->from->vID << "," << pEdge->to->vID << ","
+		Edge* pEdge = edgeList[iter];
+		outFile << iter << "," << pEdge->from->vID << "," << pEdge->to->vID << ","
 		<< pEdge->weight << "\n";
 	}
+	// then one section per attribute column
+	vertexAttributes.write(outFile, "#VATTR");
+	edgeAttributes.write(outFile, "#EATTR");
   	outFile.close();
 }
 //---------------------------------------------------------------------------------
+bool NiceGraph::saveToMappedFile(string filename)
+{
+	// names, colors and attributes stay in the .bgx; this is for running the
+	// read-only analyses on graphs too big to load, see MappedGraph
+	return MappedGraph::write(filename, getSnapshot(), isDirected,
+		positions.xData(), positions.yData(), positions.zData());
+}
+//---------------------------------------------------------------------------------
+bool NiceGraph::loadFromMappedFile(string filename)
+{
+	// vertices keep their IDs and positions, everything else starts at the
+	// defaults; edges are numbered afresh in row order.  Like loadFromFile()
+	// this clears what is already there
+	MappedGraph mapped;
+	if (!mapped.open(filename))
+	{
+		cout << "ERROR: Can't map " << filename << " as a BabelGraph CSR file" << endl;
+		return false;
+	}
+	mapped.advise(MappedGraph::SEQUENTIAL_ACCESS);
+
+	clearStorage();
+	isDirected = mapped.checkDirected();
+
+	int size = mapped.getNumVertices();
+	for (int v = 0; v < size; v++)
+	{
+		int v_id = mapped.getVID(v);
+		vertexList.insertAt(v_id, vertexPool.create());
+		if (v_id >= positions.size())
+			positions.resize(v_id + 1);
+		vertexList[v_id]->vID = v_id;
+		vertexList[v_id]->vColor = YELLOW;
+		vertexList[v_id]->vName = names.intern(" ");
+		vertexAttributes.addRow(v_id);
+		setXYZPos(v_id, mapped.getXPositions()[v], mapped.getYPositions()[v], mapped.getZPositions()[v]);
+	}
+
+	// an undirected edge is in both rows; addEdges() keeps one of the two
+	vector<pair<int,int> > edges;
+	vector<float> weights;
+	edges.reserve(mapped.getNumEdges());
+	weights.reserve(mapped.getNumEdges());
+	for (int v = 0; v < size; v++)
+	{
+		MappedGraph::Row row = mapped.outRow(v);
+		const float *w = mapped.outWeights(v);
+		for (const int *u = row.begin(); u != row.end(); u++, w++)
+			if (isDirected || (v < *u))
+			{
+				edges.push_back(make_pair(mapped.getVID(v), mapped.getVID(*u)));
+				weights.push_back(*w);
+			}
+	}
+	addEdges(edges, weights);
+
+	// a loaded graph starts with no history
+	journal.reset();
+	return true;
+}
+//---------------------------------------------------------------------------------
 // thanks to http://oopweb.com/CPP/Documents/CPPHOWTO/Volume/C++Programming-HOWTO-7.html
 void NiceGraph::tokenize (const string &str, vector<string> &tokens, const string &delimiters)
 {
@@ -42,7 +42,22 @@
 #include<fstream>
 #include<climits>
 #include<queue>
+#include<set>
 #include<algorithm>
+#include<iterator>
+#include<memory>
+#include<cstddef>
+
+#include "GraphSnapshot.hpp"
+#include "SlotVector.hpp"
+#include "EdgeIndex.hpp"
+#include "NodePool.hpp"
+#include "PositionBuffer.hpp"
+#include "StringPool.hpp"
+#include "AttributeStore.hpp"
+#include "MappedGraph.hpp"
+#include "GraphJournal.hpp"
+#include "PersonalizedPageRank.hpp"
 
 using namespace std;
 
@@ -52,8 +67,7 @@ struct Edge;
 struct Vertex {
 
 	int vID, vColor;
-	string vName;
-	float posX, posY, posZ;
+	unsigned int vName;		// handle into the graph's name pool
 	map<int, Edge*> in, out;
 } ;
 
@@ -63,8 +77,117 @@ struct Edge {
 	float weight;
 } ;
 
-typedef map<int,Vertex*> vertexMap;
-typedef map<int,Edge*> edgeMap;
+typedef SlotVector<Vertex*> vertexStore;
+typedef SlotVector<Edge*> edgeStore;
+
+// A NeighborRange is a read-only view of the neighbors of one vertex.  It
+// walks the vertex's own in/out edge maps, so nothing is copied and nothing
+// is allocated; it is only good until the graph is next edited.
+//
+// The ALL view gives each neighbor once: out-neighbors first, then the
+// in-neighbors that are not also out-neighbors.  On an undirected graph each
+// edge is stored only once, as an out edge of one end and an in edge of the
+// other, so all three views walk both maps and need no such check.
+//
+//	NeighborRange ns = g.getNeighbors(v);
+//	for (NeighborRange::iterator n = ns.begin(); n != ns.end(); ++n)
+//		... *n is a neighbor vID, n.edge() the edge that reaches it ...
+
+class NeighborRange {
+
+	public:
+	enum Direction {OUT_NEIGHBORS, IN_NEIGHBORS, ALL_NEIGHBORS};
+
+	class iterator {
+
+		public:
+		typedef forward_iterator_tag iterator_category;
+		typedef int value_type;
+		typedef ptrdiff_t difference_type;
+		typedef const int * pointer;
+		typedef int reference;
+
+		int operator*() const { return onOut ? pos->second->to->vID : pos->second->from->vID; }
+		const Edge * edge() const { return pos->second; }
+
+		iterator & operator++()
+		{
+			++pos;
+			settle();
+			return *this;
+		}
+
+		iterator operator++(int)
+		{
+			iterator old = *this;
+			++(*this);
+			return old;
+		}
+
+		bool operator==(const iterator &other) const { return (onOut == other.onOut) && (pos == other.pos); }
+		bool operator!=(const iterator &other) const { return !(*this == other); }
+
+		private:
+		friend class NeighborRange;
+		iterator(const NeighborRange &r, bool out, map<int,Edge*>::const_iterator p)
+		{
+			v = r.v;
+			index = r.index;
+			all = (r.dir == ALL_NEIGHBORS);
+			onOut = out;
+			pos = p;
+		}
+
+		// step over the end of the out map and over in-neighbors already seen
+		void settle()
+		{
+			if (!all)
+				return;
+			if (onOut && (pos == v->out.end()))
+			{
+				onOut = false;
+				pos = v->in.begin();
+			}
+			if (!onOut && (index != NULL))
+			{
+				while ((pos != v->in.end()) && (index->find(v->vID, pos->second->from->vID) >= 0))
+					++pos;
+			}
+		}
+
+		const Vertex *v;
+		const EdgeIndex *index;
+		bool all, onOut;
+		map<int,Edge*>::const_iterator pos;
+	};
+
+	// pass a NULL edgeIndex for an undirected ALL view
+	NeighborRange(const Vertex *vertex, Direction d, const EdgeIndex *edgeIndex)
+	{
+		v = vertex;
+		dir = d;
+		index = edgeIndex;
+	}
+
+	iterator begin() const
+	{
+		iterator it(*this, dir != IN_NEIGHBORS, dir != IN_NEIGHBORS ? v->out.begin() : v->in.begin());
+		it.settle();
+		return it;
+	}
+
+	iterator end() const
+	{
+		return dir == OUT_NEIGHBORS ? iterator(*this, true, v->out.end()) : iterator(*this, false, v->in.end());
+	}
+
+	bool empty() const { return begin() == end(); }
+
+	private:
+	const Vertex *v;
+	Direction dir;
+	const EdgeIndex *index;
+};
 
 
 class NiceGraph {
@@ -81,10 +204,12 @@ class NiceGraph {
 	void makeKRegularGraph (int numVertices, int k);
 	void makeStrangersBanquetGraph(int numVertices, int groups, float density, float mu);
 	void makeBinaryTreeGraph(int numVertices);
-	void addVertex();
-	void addVertex(string newName);
-	void removeVertex (int vertexID);
+	int addVertex();			// returns the new vertex ID
+	int addVertex(string newName);
+	void removeVertex (int vertexID);		// also removes its edges
+	void removeVertices (const set<int> &vertexIDs);
 	void addEdge (int fromID, int toID);
+	int addEdges (const vector<pair<int,int> > &edges, const vector<float> &weights = vector<float>());	// returns how many were added
 	void removeEdge (int from, int to);
 	void removeEdge (int edgeID);
 	int getEdgeID(int vertexID1, int vertexID2);
@@ -97,17 +222,22 @@ class NiceGraph {
 	bool testConnected (int vertexID1, int vertexID2);
 	bool testFromToConnected(int vertexID1, int vertexID2);
 	bool checkDirected();
-	void makeUndirected();
+	void makeUndirected();		// merges reciprocal edge pairs into single undirected edges
 	bool validVID(int ID);
 	bool validEID(int ID);
+	unsigned int getVertexGeneration(int ID);	// changes whenever the ID is freed
 	void getEdgeIndexList(vector<int> & list);
 	void getVertexIndexList(vector<int> & list);
+	void getIncidentEdges(int vertexID, vector<int> & list);	// IDs of the edges in and out of a vertex
 
 	// Neighborhoods and such...
 	// get neighborlist, etc.
 	vector<int> getNeighborList(int vertexID);
 	vector<int> getInNeighborList(int vertexID);
 	vector<int> getOutNeighborList(int vertexID);
+	NeighborRange getNeighbors(int vertexID);		// views, no copying
+	NeighborRange getInNeighbors(int vertexID);
+	NeighborRange getOutNeighbors(int vertexID);
 	
 	// Graph Extrinsic properties
 	string getVertexName(int vertexID);
@@ -115,19 +245,80 @@ class NiceGraph {
 	int getVertexColor (int vertexID);
 	void setVertexColor (int vertexID, int newColor);
 
+	// Named, typed columns with one value per vertex or edge ID; rows come and
+	// go with the vertices and edges, and the columns are saved with the graph.
+	// The journal knows columns by name, so a column removed from the store
+	// just has its values left out by undo.
+	AttributeStore & getVertexAttributes();
+	AttributeStore & getEdgeAttributes();
+	void setVertexAttribute(int col, int vertexID, string text);	// like setText() on the store, but journaled
+	void setEdgeAttribute(int col, int edgeID, string text);
+
+	// Every edit above is journaled (see GraphJournal.hpp): views of the graph
+	// can catch up from a cursor with getJournal().getChangesSince(), and each
+	// public call is one step for undo().  Positions, attribute columns and
+	// values set directly on the stores are not journaled.
+	const GraphJournal & getJournal();
+	bool undo();		// false if there was nothing to undo
+	bool redo();
+	bool canUndo();
+	bool canRedo();
+
 	// Graph Analysis
 	void avgShortestPathMatrix(map<int,float> &paths );
-	float avgShortestPathofGraph_FW();	// better to use FW...
-	float avgShortestPathofGraph_BFS(); // works but is SLOW!! WHY??
+	float avgShortestPathofGraph_FW();	// both run one BFS per vertex (Dijkstra if weighted), in parallel
+	float avgShortestPathofGraph_BFS();
 	float getHomophilicDyadDensity();
-	void getPageRank(map<int,float> &pageRank, int iterations = 100, float damping = 0.85);
+	// ranks sum to 1; runs until the ranks change by less than tolerance (L1) or maxIterations
+	PageRankReport getPageRank(map<int,float> &pageRank, int maxIterations = 100, float damping = 0.85, double tolerance = 1e-6);
 	float getClusteringCoefficient(int index);
+	void getClusteringMetrics(ClusteringMetrics &metrics);	// every vertex at once, and transitivity; dense
 	void getClosenessCentrality(map<int,float> &cCentrality);
+	void getPathMetrics(PathMetrics &metrics);	// all of the above and more in one pass; dense, see getSnapshot()
+	// sampled estimates for big graphs, k pivots or until within targetError, see GraphSnapshot
+	void estimatePathMetrics(PathEstimate &estimate, int pivots, float targetError = 0);
+	// the k vertices (by ID) a walk restarting at the given ones visits most,
+	// with their personalized PageRank; local, see PersonalizedPageRank
+	void getRelatedVertices(int index, int k, vector<pair<int,float> > &related);
+	void getRelatedVertices(const vector<int> &indices, int k, vector<pair<int,float> > &related);
+
+	// Read-only CSR copy of the graph for the analyses, rebuilt lazily after edits.
+	// The reference from getSnapshot() is only good until the next edit;
+	// shareSnapshot() keeps that version alive for as long as it is held,
+	// eg. by an analysis running in another thread
+	const GraphSnapshot & getSnapshot();
+	shared_ptr<const GraphSnapshot> shareSnapshot();
+
+	// Storage order of the snapshot.  Vertex IDs never change; reorder() only
+	// picks which dense index each one gets (GraphSnapshot::getDenseIndex()
+	// is the ID --> position map), so neighbors sit close together in memory.
+	// The order sticks until the next reorder(); vertices added later go at
+	// the end in ID order.
+	enum ORDERINGS {ID_ORDER=0, RCM_ORDER, DEGREE_ORDER, GORDER};
+	void reorder(int strategy);
+	void getVertexOrder(vector<int> &order);	// vertex IDs in storage order
+
+	// Snapshots also carry their rows gap encoded (see CompressedGraph) and
+	// run BFS, PageRank and triangle counting on those; off by default
+	void setCompressedRows(bool on);
+	bool getCompressedRows();
+
+	// Bumped by every change except moving vertices, and never reused, so
+	// results can be tagged with it to tell when they have gone stale
+	unsigned long getVersion();
 
 	// Graph plotting things
 	void setXYZPos(int vertexID, float x, float y, float z);
 	void getXYZPos(int vertexID, vector<float> & xyz); 	// takes a reference to 3-vector and returns it full of coordinates
 	void getEndpoints (int edgeID, vector<float> & v1, vector<float> &v2); // return endpoints of an edge
+	void getEdgeVertices (int edgeID, int &from, int &to);
+
+	// Bulk access to the coordinate arrays, indexed by vertex ID for IDs below
+	// getVertexIDLimit(); entries for unused IDs are meaningless
+	int getVertexIDLimit();
+	float * getXPositions();
+	float * getYPositions();
+	float * getZPositions();
 	
 	// Graph Layout Algorithms
 	void randomLayoutAll(float xmin, float xmax, float ymin, float ymax, float zmin, float zmax);
@@ -142,15 +333,43 @@ class NiceGraph {
 	// file operations
 	void loadFromFile(string filename);
 	void saveToFile(string filename);
+	bool saveToMappedFile(string filename);	// binary CSR for MappedGraph, structure and positions only
+	bool loadFromMappedFile(string filename);	// and back, returns false if it can't be mapped
 
 	// Other stuff
+	void getMemoryUsage(size_t &liveBytes, size_t &reservedBytes);	// vertex and edge nodes, plus the name pool
 	enum COLORS {YELLOW=0, PURPLE, RED, ORANGE, WHITE, BLACK, GREEN, BLUE};
 	
 private:
-	int edgeIDCounter, vertexIDCounter;
-	vertexMap vertexList;
-	edgeMap edgeList;
+	vertexStore vertexList;
+	edgeStore edgeList;
+	EdgeIndex edgeIndex;	// (from, to) --> edge ID, (smaller, larger) if undirected
+	void edgeKey(int &from, int &to);
+	NodePool<Vertex> vertexPool;
+	NodePool<Edge> edgePool;
+	PositionBuffer positions;	// x, y, z by vertex ID
+	StringPool names;			// vertex names, each distinct one stored once
+	AttributeStore vertexAttributes;
+	AttributeStore edgeAttributes;
+	void clearStorage();
 	bool isDirected;
+	void makeDirected();
+	void rebuildEdgeIndex();
+	GraphJournal journal;
+	bool replay(GraphJournal::MODE mode);
+	void restoreVertex(const GraphChange &removed);
+	void restoreEdge(const GraphChange &removed);
+	void restoreAttributes(AttributeStore &store, int id, const GraphChange &removed);
+	void recordEdgeAddition(const Edge *e);
+	void recordEdgeRemoval(const Edge *e);
+	shared_ptr<const GraphSnapshot> snapshot;	// empty until asked for after an edit
+	unsigned long version;
+	vector<int> vertexOrder;	// vertex IDs in the order set by reorder(), empty for ID order
+	bool compressedRows;
+	PersonalizedPageRank relatedRank;	// kept for its working arrays
+	void nextVersion();
+	void invalidateSnapshot();
+	void buildSnapshot();
 	void tokenize (const string &str, vector<string> &tokens, const string &delimiters);
 
 };
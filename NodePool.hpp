@@ -0,0 +1,120 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE:  NodePool.hpp
+*  	DESCRIPTION:  Block allocator that hands out the Vertex and Edge nodes
+*					of a NiceGraph
+*	URL: http://www.babelgraph.org/
+*/
+
+#ifndef NODEPOOL_HPP_
+#define NODEPOOL_HPP_
+
+#include<cstdlib>
+#include<new>
+#include<vector>
+
+using namespace std;
+
+// A NodePool carves objects of one type out of large blocks instead of
+// calling new for every one.  Released nodes go on a free list and are
+// handed out again by the next create().
+//
+// clear() gives all the blocks back at once WITHOUT running any
+// destructors, so the owner must release() any node whose type needs its
+// destructor run (eg. one holding a map or string) before calling it.
+
+template <class T>
+class NodePool {
+
+	public:
+	NodePool(int nodesPerBlock = 1024)
+	{
+		blockSize = nodesPerBlock;
+		freeList = NULL;
+		live = 0;
+	}
+
+	~NodePool() { clear(); }
+
+	T * create()
+	{
+		if (freeList == NULL)
+			addBlock();
+
+		Node *node = freeList;
+		freeList = node->next;
+		live++;
+		return new (node->storage) T();
+	}
+
+	void release(T *item)
+	{
+		if (item == NULL)
+			return;
+
+		item->~T();
+		Node *node = reinterpret_cast<Node*>(item);
+		node->next = freeList;
+		freeList = node;
+		live--;
+	}
+
+	void clear()
+	{
+		for (unsigned int b = 0; b < blocks.size(); b++)
+			free(blocks[b]);
+		blocks.clear();
+		freeList = NULL;
+		live = 0;
+	}
+
+	// memory accounting, in bytes
+	size_t liveBytes() const { return live * sizeof(Node); }
+	size_t reservedBytes() const { return blocks.size() * blockSize * sizeof(Node); }
+
+	private:
+	union Node {
+		Node *next;
+		char storage[sizeof(T)];
+		long double alignLongDouble;	// make the storage suitably aligned for T
+		void *alignPointer;
+	};
+
+	void addBlock()
+	{
+		Node *block = (Node*) malloc(blockSize * sizeof(Node));
+		if (block == NULL)
+			throw bad_alloc();
+		blocks.push_back(block);
+
+		// thread the new nodes onto the free list
+		for (int n = blockSize - 1; n >= 0; n--)
+		{
+			block[n].next = freeList;
+			freeList = &block[n];
+		}
+	}
+
+	// no copying
+	NodePool(const NodePool &);
+	NodePool & operator=(const NodePool &);
+
+	vector<Node*> blocks;
+	Node *freeList;
+	int blockSize;
+	size_t live;
+};
+
+#endif // NODEPOOL_HPP_
@@ -0,0 +1,133 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE: PersonalizedPageRank.cpp
+*  	DESCRIPTION: Implementation of local personalized PageRank
+*	URL: http://www.babelgraph.org/
+*/
+
+#include "PersonalizedPageRank.hpp"
+#include "GraphSnapshot.hpp"
+
+#include<algorithm>
+
+//------------------------------------------------------------------------------
+PersonalizedPageRank::PersonalizedPageRank()
+{
+	pushes = lastTouched = 0;
+}
+//------------------------------------------------------------------------------
+void PersonalizedPageRank::query(const GraphSnapshot &g, int seed, int k, vector<pair<int,float> > &top,
+	float alpha, float epsilon)
+{
+	vector<int> seeds (1, seed);
+	query(g, seeds, k, top, alpha, epsilon);
+}
+//------------------------------------------------------------------------------
+void PersonalizedPageRank::query(const GraphSnapshot &g, const vector<int> &seeds, int k, vector<pair<int,float> > &top,
+	float alpha, float epsilon)
+{
+	top.clear();
+	pushes = lastTouched = 0;
+	if (seeds.empty())
+		return;
+
+	// sized once per graph size, then only ever cleared where touched
+	int size = g.getNumVertices();
+	if ((int) score.size() != size)
+	{
+		score.assign(size, 0);
+		residual.assign(size, 0);
+		queued.assign(size, 0);
+	}
+
+	float start = 1.0f / seeds.size();
+	for (unsigned int s = 0; s < seeds.size(); s++)
+		addResidual(g, seeds[s], start, epsilon);
+
+	for (unsigned int head = 0; head < queue.size(); head++)
+	{
+		int u = queue[head];
+		queued[u] = 0;
+
+		float r = residual[u];
+		int degree = g.getOutDegree(u);
+		if (r < epsilon * max(degree, 1))
+			continue;
+
+		score[u] += alpha * r;
+		residual[u] = 0;
+		pushes++;
+
+		// a walk with nowhere to go restarts at the seeds
+		if (degree == 0)
+		{
+			float back = (1 - alpha) * r / seeds.size();
+			for (unsigned int s = 0; s < seeds.size(); s++)
+				addResidual(g, seeds[s], back, epsilon);
+		}
+		else
+		{
+			float share = (1 - alpha) * r / degree;
+			for (const int *v = g.outBegin(u); v != g.outEnd(u); v++)
+				addResidual(g, *v, share, epsilon);
+		}
+	}
+
+	// rank what was touched, leaving the seeds out
+	vector<pair<float,int> > ranked;
+	for (unsigned int t = 0; t < touched.size(); t++)
+	{
+		int v = touched[t];
+		if ((score[v] > 0) && (find(seeds.begin(), seeds.end(), v) == seeds.end()))
+			ranked.push_back(make_pair(-score[v], v));	// negated, so ties go to the lower index
+	}
+	int count = max(0, min(k, (int) ranked.size()));		// nothing for k <= 0
+	partial_sort(ranked.begin(), ranked.begin() + count, ranked.end());
+	for (int t = 0; t < count; t++)
+		top.push_back(make_pair(ranked[t].second, -ranked[t].first));
+
+	// and leave the arrays clean for the next query
+	lastTouched = touched.size();
+	for (unsigned int t = 0; t < touched.size(); t++)
+	{
+		score[touched[t]] = 0;
+		residual[touched[t]] = 0;
+	}
+	touched.clear();
+	queue.clear();
+}
+//------------------------------------------------------------------------------
+void PersonalizedPageRank::addResidual(const GraphSnapshot &g, int v, float amount, float epsilon)
+{
+	if ((residual[v] == 0) && (score[v] == 0))
+		touched.push_back(v);
+
+	residual[v] += amount;
+	if (!queued[v] && (residual[v] >= epsilon * max(g.getOutDegree(v), 1)))
+	{
+		queued[v] = 1;
+		queue.push_back(v);
+	}
+}
+//------------------------------------------------------------------------------
+int PersonalizedPageRank::getPushes() const
+{
+	return pushes;
+}
+//------------------------------------------------------------------------------
+int PersonalizedPageRank::getTouched() const
+{
+	return lastTouched;
+}
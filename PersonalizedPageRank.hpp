@@ -0,0 +1,75 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE:  PersonalizedPageRank.hpp
+*  	DESCRIPTION:  Header file for local personalized PageRank queries,
+*					used for finding related vertices
+*	URL: http://www.babelgraph.org/
+*/
+
+#ifndef PERSONALIZEDPAGERANK_HPP_
+#define PERSONALIZEDPAGERANK_HPP_
+
+#include<vector>
+#include<utility>
+
+using namespace std;
+
+class GraphSnapshot;
+
+// A PersonalizedPageRank answers "which vertices are most related to these
+// seeds": the PageRank of a random walk that restarts at the seeds (with
+// probability alpha at each step) instead of anywhere, ranked.
+//
+// It is computed locally by pushing (Andersen, Chung and Lang): every
+// vertex holds a settled score and a residual still to be spread, starting
+// with all of it on the seeds.  A push settles alpha of a vertex's residual
+// and passes the rest evenly to its out neighbors (back to the seeds if it
+// has none), and only vertices whose residual is at least epsilon times
+// their degree are pushed.  That takes at most 1/(alpha epsilon) pushes
+// whatever the size of the graph, so a query only touches the part of the
+// graph near the seeds; the scores are within epsilon per unit of degree
+// of the exact ones.
+//
+// The working arrays are kept from one query to the next and only the
+// entries a query touched are cleared after it, so a query costs nothing
+// in proportion to the graph.  Indices are dense, as in the snapshot.  Not
+// for use by two threads at once.
+
+class PersonalizedPageRank {
+
+	public:
+	PersonalizedPageRank();
+
+	// the k highest scoring vertices other than the seeds, best first
+	void query(const GraphSnapshot &g, int seed, int k, vector<pair<int,float> > &top,
+		float alpha = 0.15f, float epsilon = 1e-4f);
+	void query(const GraphSnapshot &g, const vector<int> &seeds, int k, vector<pair<int,float> > &top,
+		float alpha = 0.15f, float epsilon = 1e-4f);
+
+	// the work done by the last query
+	int getPushes() const;
+	int getTouched() const;
+
+	private:
+	vector<float> score, residual;
+	vector<char> queued;
+	vector<int> touched, queue;
+	int pushes, lastTouched;
+
+	void addResidual(const GraphSnapshot &g, int v, float amount, float epsilon);
+
+};
+
+#endif // PERSONALIZEDPAGERANK_HPP_
@@ -0,0 +1,111 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE: PositionBuffer.cpp
+*  	DESCRIPTION: Implementation of the vertex coordinate arrays
+*	URL: http://www.babelgraph.org/
+*/
+
+#include "PositionBuffer.hpp"
+#include<cstring>
+#include<new>
+
+//------------------------------------------------------------------------------
+PositionBuffer::PositionBuffer()
+{
+	xs = ys = zs = NULL;
+	count = capacity = 0;
+}
+//------------------------------------------------------------------------------
+PositionBuffer::~PositionBuffer()
+{
+	clear();
+}
+//------------------------------------------------------------------------------
+void PositionBuffer::resize(int n)
+{
+	if (n > capacity)
+	{
+		// grow geometrically, rounded up to whole vector widths
+		int newCapacity = capacity > 0 ? capacity : PAD;
+		while (newCapacity < n)
+			newCapacity *= 2;
+
+		float *nx = allocate(newCapacity);
+		float *ny = allocate(newCapacity);
+		float *nz = allocate(newCapacity);
+		if (count > 0)
+		{
+			memcpy(nx, xs, count * sizeof(float));
+			memcpy(ny, ys, count * sizeof(float));
+			memcpy(nz, zs, count * sizeof(float));
+		}
+		release(xs);
+		release(ys);
+		release(zs);
+		xs = nx;
+		ys = ny;
+		zs = nz;
+		capacity = newCapacity;
+	}
+
+	// slots past the old end start at the origin
+	for (int i = count; i < n; i++)
+		xs[i] = ys[i] = zs[i] = 0;
+
+	count = n;
+}
+//------------------------------------------------------------------------------
+void PositionBuffer::clear()
+{
+	release(xs);
+	release(ys);
+	release(zs);
+	xs = ys = zs = NULL;
+	count = capacity = 0;
+}
+//------------------------------------------------------------------------------
+int PositionBuffer::size() const
+{
+	return count;
+}
+//------------------------------------------------------------------------------
+void PositionBuffer::set(int id, float x, float y, float z)
+{
+	xs[id] = x;
+	ys[id] = y;
+	zs[id] = z;
+}
+//------------------------------------------------------------------------------
+float * PositionBuffer::allocate(int n)
+{
+	// over-allocate and stash the pointer malloc gave us just below the
+	// aligned block, so release() can find it again
+	char *raw = (char*) malloc(n * sizeof(float) + ALIGNMENT + sizeof(void*));
+	if (raw == NULL)
+		throw bad_alloc();
+
+	size_t start = (size_t)(raw + sizeof(void*));
+	float *aligned = (float*)((start + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1));
+	((void**) aligned)[-1] = raw;
+
+	memset(aligned, 0, n * sizeof(float));
+	return aligned;
+}
+//------------------------------------------------------------------------------
+void PositionBuffer::release(float *p)
+{
+	if (p != NULL)
+		free(((void**) p)[-1]);
+}
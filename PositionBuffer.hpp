@@ -0,0 +1,67 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE:  PositionBuffer.hpp
+*  	DESCRIPTION:  Header file for the x, y, z coordinate arrays that hold the
+*					vertex positions of a NiceGraph
+*	URL: http://www.babelgraph.org/
+*/
+
+#ifndef POSITIONBUFFER_HPP_
+#define POSITIONBUFFER_HPP_
+
+#include<cstdlib>
+
+using namespace std;
+
+// A PositionBuffer keeps the coordinates as three separate float arrays
+// (structure of arrays) indexed by vertex ID, so layout loops run over
+// contiguous memory and can be vectorized.  Each array starts on a 32 byte
+// boundary and is padded out to a multiple of 8 floats; the padding and the
+// slots of removed vertices are zero or hold stale but finite values.
+
+class PositionBuffer {
+
+	public:
+	PositionBuffer();
+	~PositionBuffer();
+
+	void resize(int n);		// keeps the old coordinates, new slots start at the origin
+	void clear();
+	int size() const;
+
+	void set(int id, float x, float y, float z);
+
+	float * xData() { return xs; }
+	float * yData() { return ys; }
+	float * zData() { return zs; }
+	const float * xData() const { return xs; }
+	const float * yData() const { return ys; }
+	const float * zData() const { return zs; }
+
+	private:
+	enum {ALIGNMENT = 32, PAD = 8};
+
+	static float * allocate(int n);
+	static void release(float *p);
+
+	// no copying
+	PositionBuffer(const PositionBuffer &);
+	PositionBuffer & operator=(const PositionBuffer &);
+
+	float *xs, *ys, *zs;
+	int count, capacity;
+};
+
+#endif // POSITIONBUFFER_HPP_
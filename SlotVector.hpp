@@ -0,0 +1,149 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE:  SlotVector.hpp
+*  	DESCRIPTION:  Dense slot array with a free list, used to store the
+*					vertices and edges of a NiceGraph by ID
+*	URL: http://www.babelgraph.org/
+*/
+
+#ifndef SLOTVECTOR_HPP_
+#define SLOTVECTOR_HPP_
+
+#include<vector>
+
+using namespace std;
+
+// A SlotVector maps small integer IDs to items by storing them in a plain
+// array indexed by ID.  Lookups and validity checks are O(1).
+//
+// IDs never move: erasing an item only empties its slot and puts the ID on
+// a free list so a later insert() can reuse it.  Every slot carries a
+// generation counter that is bumped when the slot is emptied, so anyone who
+// remembers an (ID, generation) pair can tell whether the item is still the
+// one they saw.
+//
+// To visit the items in ID order:
+//	for (int id = list.begin(); id != list.end(); id = list.next(id))
+
+template <class T>
+class SlotVector {
+
+	public:
+	SlotVector() { live = 0; }
+
+	// add an item in the first free slot and return its ID
+	int insert(const T &item)
+	{
+		while (!freeList.empty())
+		{
+			int id = freeList.back();
+			freeList.pop_back();
+			if (!used[id])		// slot may have been refilled by insertAt()
+			{
+				fill(id, item);
+				return id;
+			}
+		}
+
+		int id = items.size();
+		items.push_back(T());
+		used.push_back(false);
+		generations.push_back(0);
+		fill(id, item);
+		return id;
+	}
+
+	// add an item with a given ID (eg. when loading from a file)
+	void insertAt(int id, const T &item)
+	{
+		while ((int) items.size() <= id)
+		{
+			freeList.push_back(items.size());
+			items.push_back(T());
+			used.push_back(false);
+			generations.push_back(0);
+		}
+		if (used[id])
+			items[id] = item;
+		else
+			fill(id, item);
+	}
+
+	void erase(int id)
+	{
+		if (!valid(id))
+			return;
+
+		items[id] = T();
+		used[id] = false;
+		generations[id]++;
+		freeList.push_back(id);
+		live--;
+	}
+
+	void clear()
+	{
+		items.clear();
+		used.clear();
+		generations.clear();
+		freeList.clear();
+		live = 0;
+	}
+
+	void reserve(int n)
+	{
+		items.reserve(n);
+		used.reserve(n);
+		generations.reserve(n);
+	}
+
+	bool valid(int id) const { return (id >= 0) && (id < (int) items.size()) && used[id]; }
+	unsigned int generation(int id) const { return generations[id]; }
+	int size() const { return live; }
+	bool empty() const { return live == 0; }
+
+	// one past the largest ID that has ever been handed out
+	int idLimit() const { return items.size(); }
+
+	T & operator[](int id) { return items[id]; }
+	const T & operator[](int id) const { return items[id]; }
+
+	// iteration over the occupied slots in increasing ID order
+	int begin() const { return next(-1); }
+	int end() const { return items.size(); }
+	int next(int id) const
+	{
+		id++;
+		while ((id < (int) items.size()) && !used[id])
+			id++;
+		return id;
+	}
+
+	private:
+	void fill(int id, const T &item)
+	{
+		items[id] = item;
+		used[id] = true;
+		live++;
+	}
+
+	vector<T> items;	// not "slots", which Qt defines away
+	vector<bool> used;
+	vector<unsigned int> generations;
+	vector<int> freeList;
+	int live;
+};
+
+#endif // SLOTVECTOR_HPP_
@@ -0,0 +1,128 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE: StringPool.cpp
+*  	DESCRIPTION: Implementation of the interned string pool
+*	URL: http://www.babelgraph.org/
+*/
+
+#include "StringPool.hpp"
+#include<cstring>
+
+//------------------------------------------------------------------------------
+StringPool::StringPool()
+{
+	clear();
+}
+//------------------------------------------------------------------------------
+unsigned int StringPool::intern(const string &s)
+{
+	unsigned int slot;
+	unsigned int handle = lookup(s.data(), s.size(), slot);
+	if (handle != NOT_FOUND)
+		return handle;
+
+	// append the new string and its terminator
+	handle = offsets.size() - 1;
+	chars.insert(chars.end(), s.begin(), s.end());
+	chars.push_back('\0');
+	offsets.push_back(chars.size());
+	table[slot] = handle;
+
+	// keep the table at most half full
+	if (2 * (unsigned int) size() > table.size())
+		rebuild(2 * table.size());
+
+	return handle;
+}
+//------------------------------------------------------------------------------
+unsigned int StringPool::find(const string &s) const
+{
+	unsigned int slot;
+	return lookup(s.data(), s.size(), slot);
+}
+//------------------------------------------------------------------------------
+const char * StringPool::c_str(unsigned int handle) const
+{
+	return &chars[offsets[handle]];
+}
+//------------------------------------------------------------------------------
+unsigned int StringPool::length(unsigned int handle) const
+{
+	return offsets[handle + 1] - offsets[handle] - 1;
+}
+//------------------------------------------------------------------------------
+string StringPool::get(unsigned int handle) const
+{
+	return string(c_str(handle), length(handle));
+}
+//------------------------------------------------------------------------------
+int StringPool::size() const
+{
+	return offsets.size() - 1;
+}
+//------------------------------------------------------------------------------
+size_t StringPool::bytes() const
+{
+	return chars.capacity() + (offsets.capacity() + table.capacity()) * sizeof(unsigned int);
+}
+//------------------------------------------------------------------------------
+void StringPool::clear()
+{
+	chars.clear();
+	offsets.assign(1, 0);
+	rebuild(16);
+}
+//------------------------------------------------------------------------------
+unsigned int StringPool::hash(const char *s, size_t len)
+{
+	// FNV-1a
+	unsigned int h = 2166136261u;
+	for (size_t i = 0; i < len; i++)
+	{
+		h ^= (unsigned char) s[i];
+		h *= 16777619u;
+	}
+	return h;
+}
+//------------------------------------------------------------------------------
+unsigned int StringPool::lookup(const char *s, size_t len, unsigned int &slot) const
+{
+	// walk the probe sequence until we find the string or an empty slot,
+	// which is where it would go
+	slot = hash(s, len) & mask;
+	while (table[slot] != (unsigned int) NOT_FOUND)
+	{
+		unsigned int h = table[slot];
+		if ((length(h) == len) && (memcmp(c_str(h), s, len) == 0))
+			return h;
+		slot = (slot + 1) & mask;
+	}
+	return NOT_FOUND;
+}
+//------------------------------------------------------------------------------
+void StringPool::rebuild(unsigned int capacity)
+{
+	// capacity must be a power of two
+	table.assign(capacity, NOT_FOUND);
+	mask = capacity - 1;
+
+	for (int h = 0; h < size(); h++)
+	{
+		unsigned int slot = hash(c_str(h), length(h)) & mask;
+		while (table[slot] != (unsigned int) NOT_FOUND)
+			slot = (slot + 1) & mask;
+		table[slot] = h;
+	}
+}
@@ -0,0 +1,67 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE:  StringPool.hpp
+*  	DESCRIPTION:  Header file for a pool of interned strings, used for the
+*					vertex names of a NiceGraph
+*	URL: http://www.babelgraph.org/
+*/
+
+#ifndef STRINGPOOL_HPP_
+#define STRINGPOOL_HPP_
+
+#include<string>
+#include<vector>
+
+using namespace std;
+
+// A StringPool stores every distinct string once, back to back in a single
+// character array, and hands out a 32 bit handle for it.  Interning the same
+// text twice gives the same handle, so thousands of vertices labelled alike
+// share one copy.  A hash table of handles (linear probing, at most half
+// full) finds existing strings in constant expected time.
+//
+// Strings are never removed; clear() empties the whole pool.  Pointers from
+// c_str() are only good until the next intern().
+
+class StringPool {
+
+	public:
+	StringPool();
+
+	enum {NOT_FOUND = 0xffffffff};
+
+	unsigned int intern(const string &s);		// returns the handle, adding s if it is new
+	unsigned int find(const string &s) const;	// returns NOT_FOUND if s isn't there
+	const char * c_str(unsigned int handle) const;
+	unsigned int length(unsigned int handle) const;
+	string get(unsigned int handle) const;
+
+	int size() const;		// number of distinct strings
+	size_t bytes() const;	// memory held, in bytes
+	void clear();
+
+	private:
+	vector<char> chars;				// all the strings, each followed by a '\0'
+	vector<unsigned int> offsets;	// string h runs from offsets[h] to offsets[h+1] - 1
+	vector<unsigned int> table;		// hash table of handles
+	unsigned int mask;
+
+	static unsigned int hash(const char *s, size_t len);
+	unsigned int lookup(const char *s, size_t len, unsigned int &slot) const;
+	void rebuild(unsigned int capacity);
+
+};
+
+#endif // STRINGPOOL_HPP_
@@ -0,0 +1,213 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE: GraphBenchmarks.cpp
+*  	DESCRIPTION: Timings of the analyses on generated graphs, see
+*					benchmarks.pro
+*	URL: http://www.babelgraph.org/
+*/
+
+#include "NiceGraph.hpp"
+#include "CompressedGraph.hpp"
+#include "DistanceMatrix.hpp"
+
+#include<cstdio>
+#include<cstdlib>
+#include<ctime>
+#include<cstring>
+#include<cmath>
+#include<climits>
+#include<algorithm>
+#include<random>
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+static double seconds()
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return (double) clock() / CLOCKS_PER_SEC;
+#endif
+}
+//------------------------------------------------------------------------------
+// A triangulated side x side grid with a few long edges, its vertex IDs
+// shuffled so that ID order has no locality left, the way a graph read
+// from a file often arrives; the same one every run for the same seed
+static void shuffledGrid(NiceGraph &g, int side, unsigned int seed)
+{
+	mt19937 random (seed);
+	int n = side * side;
+	vector<int> perm (n);
+	for (int v = 0; v < n; v++)
+		perm[v] = v;
+	shuffle(perm.begin(), perm.end(), random);
+
+	g.makeEmptyGraph(n);
+	g.makeUndirected();
+	vector<pair<int,int> > edges;
+	for (int x = 0; x < side; x++)
+		for (int y = 0; y < side; y++)
+		{
+			int v = x * side + y;
+			if (x + 1 < side)
+				edges.push_back(make_pair(perm[v], perm[v + side]));
+			if (y + 1 < side)
+				edges.push_back(make_pair(perm[v], perm[v + 1]));
+			if ((x + 1 < side) && (y + 1 < side))
+				edges.push_back(make_pair(perm[v], perm[v + side + 1]));
+			if (random() % 50 == 0)
+				edges.push_back(make_pair(perm[v], perm[random() % n]));
+		}
+	g.addEdges(edges);
+}
+//------------------------------------------------------------------------------
+// NiceGraph::reorder(): how long each ordering takes to work out, and what
+// it does for the snapshot's PageRank and BFS, which stream through the rows
+static void reorderBenchmark(int side)
+{
+	NiceGraph g;
+	shuffledGrid(g, side, 7);
+
+	const char *names[] = {"ID", "RCM", "degree", "Gorder"};
+	printf("%d x %d shuffled grid, %d vertices, %d edges\n", side, side, g.getNumVertices(), g.getNumEdges());
+	printf("%-8s %10s %14s %10s %10s %12s\n", "order", "reorder", "PageRank x20", "BFS x10", "avg |gap|", "compressed");
+
+	for (int s = NiceGraph::ID_ORDER; s <= NiceGraph::GORDER; s++)
+	{
+		g.reorder(NiceGraph::ID_ORDER);
+		g.getSnapshot();
+		double start = seconds();
+		g.reorder(s);
+		const GraphSnapshot &csr = g.getSnapshot();
+		double ordering = seconds() - start;
+
+		// how far apart neighbors sit in memory
+		long long gap = 0;
+		for (int v = 0; v < csr.getNumVertices(); v++)
+			for (const int *u = csr.outBegin(v); u != csr.outEnd(v); u++)
+				gap += abs(*u - v);
+
+		// the analyses as the GUI runs them, through the snapshot
+		vector<float> rank;
+		start = seconds();
+		csr.pageRank(rank, 0.85f, 0, 20);
+		double pageRank = seconds() - start;
+
+		vector<int> distance;
+		start = seconds();
+		for (int k = 0; k < 10; k++)
+			csr.bfsDistances(csr.getDenseIndex(k * 37), distance);
+		double bfs = seconds() - start;
+
+		CompressedGraph compressed (csr);
+		printf("%-8s %9.2fs %13.3fs %9.3fs %10.0f %7.2f B/arc\n", names[s], ordering, pageRank, bfs,
+			(double) gap / csr.getNumEdges(), compressed.bytesPerEdge());
+	}
+}
+//------------------------------------------------------------------------------
+// GraphSnapshot::allPairsFW() as it was before DistanceMatrix: one plain
+// triple loop over unsigned longs, weights truncated, INT_MAX for no path
+static void plainFloydWarshall(const GraphSnapshot &csr, vector<unsigned long> &distance)
+{
+	int size = csr.getNumVertices();
+	distance.assign((size_t) size * size, INT_MAX);
+	for (int q = 0; q < size; q++)
+	{
+		distance[(size_t) q * size + q] = 0;
+		const float *w = csr.outWeights(q);
+		for (const int *r = csr.outBegin(q); r != csr.outEnd(q); r++, w++)
+			distance[(size_t) q * size + *r] = (unsigned long) *w;
+	}
+
+	for (int k = 0; k < size; k++){
+		const unsigned long *rowK = &distance[(size_t) k * size];
+		for (int i = 0; i < size; i++){
+			unsigned long *rowI = &distance[(size_t) i * size];
+			unsigned long ik = rowI[k];
+			for (int j = 0; j < size; j++){
+				unsigned int sum = ik + rowK[j];
+				if (sum < rowI[j]){
+					rowI[j] = sum; }
+			}
+		}
+	}
+}
+//------------------------------------------------------------------------------
+// DistanceMatrix::floydWarshall() against the plain version it replaced and
+// against one Dijkstra per source, on a random digraph with integer weights
+// 1..20 so that all three agree exactly
+static void floydWarshallBenchmark(int n, double p)
+{
+	srand(11);
+	NiceGraph g;
+	g.makeEmptyGraph(n);
+	vector<pair<int,int> > arcs;
+	vector<float> weights;
+	for (int i = 0; i < n; i++)
+		for (int j = 0; j < n; j++)
+			if ((i != j) && (rand() < p * RAND_MAX))
+			{
+				arcs.push_back(make_pair(i, j));
+				weights.push_back(1 + rand() % 20);
+			}
+	g.addEdges(arcs, weights);
+	const GraphSnapshot &csr = g.getSnapshot();
+	printf("random digraph, %d vertices, %d arcs, tile kernels: %s\n", n, csr.getNumEdges(), DistanceMatrix::instructionSet());
+
+	double start = seconds();
+	vector<unsigned long> plain;
+	plainFloydWarshall(csr, plain);
+	printf("%-22s %8.3fs\n", "plain Floyd-Warshall", seconds() - start);
+
+	start = seconds();
+	DistanceMatrix matrix;
+	csr.allPairsFW(matrix);
+	printf("%-22s %8.3fs\n", "DistanceMatrix", seconds() - start);
+
+	start = seconds();
+	int wrong = 0;
+	vector<double> distance;
+	for (int s = 0; s < n; s++)
+	{
+		csr.dijkstraDistances(s, distance);
+		for (int t = 0; t < n; t++)
+		{
+			double expected = (distance[t] == HUGE_VAL) ? INT_MAX : distance[t];
+			double blocked = (matrix.row(s)[t] == HUGE_VAL) ? INT_MAX : matrix.row(s)[t];
+			if ((blocked != expected) || (plain[(size_t) s * n + t] != expected))
+				wrong++;
+		}
+	}
+	printf("%-22s %8.3fs (and checking), %d pairs differ\n", "Dijkstra x n", seconds() - start, wrong);
+}
+//------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+	if ((argc < 2) || !strcmp(argv[1], "reorder"))
+		reorderBenchmark((argc > 2) ? atoi(argv[2]) : 700);
+	else if (!strcmp(argv[1], "floydwarshall"))
+		floydWarshallBenchmark((argc > 2) ? atoi(argv[2]) : 1000, (argc > 3) ? atof(argv[3]) : 0.1);
+	else
+	{
+		printf("usage: %s reorder [side]\n", argv[0]);
+		printf("       %s floydwarshall [vertices] [arc probability]\n", argv[0]);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,34 @@
+######################################################################
+# Timings of the graph analyses on generated graphs; no Qt needed.
+#	qmake && make && ./GraphBenchmarks reorder
+######################################################################
+
+TEMPLATE = app
+TARGET = GraphBenchmarks
+CONFIG += console release
+CONFIG -= qt app_bundle
+DEPENDPATH += ..
+INCLUDEPATH += ..
+
+unix|win32-g++ {
+    QMAKE_CXXFLAGS += -fopenmp
+    LIBS += -fopenmp
+}
+win32-msvc* {
+    QMAKE_CXXFLAGS += -openmp
+}
+
+SOURCES += GraphBenchmarks.cpp \
+           ../NiceGraph.cpp \
+           ../GraphSnapshot.cpp \
+           ../EdgeIndex.cpp \
+           ../PositionBuffer.cpp \
+           ../StringPool.cpp \
+           ../AttributeStore.cpp \
+           ../CompressedGraph.cpp \
+           ../MappedGraph.cpp \
+           ../GraphJournal.cpp \
+           ../BitMatrix.cpp \
+           ../DistanceMatrix.cpp \
+           ../PersonalizedPageRank.cpp \
+           ../IncrementalPageRank.cpp
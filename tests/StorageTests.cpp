@@ -0,0 +1,424 @@
+/*******************************************************************************
+*     This program is free software: you can redistribute it and/or modify     *
+*     it under the terms of the GNU General Public License as published by     *
+*     the Free Software Foundation, either version 3 of the License, or        *
+*     (at your option) any later version.                                      *
+*                                                                              *
+*     This program is distributed in the hope that it will be useful,          *
+*     but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+*     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+*     GNU General Public License for more details.                             *
+*                                                                              *
+*     You should have received a copy of the GNU General Public License        *
+*     along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+********************************************************************************/
+/* 	FILE: StorageTests.cpp
+*  	DESCRIPTION: Checks of the graph storage: the edge index, loading
+*					graph files and mapped CSR files, and of the analyses
+*					that read it, see tests.pro
+*	URL: http://www.babelgraph.org/
+*/
+
+#include "EdgeIndex.hpp"
+#include "NiceGraph.hpp"
+#include "MappedGraph.hpp"
+#include "GraphKernels.hpp"
+
+#include<iostream>
+#include<fstream>
+#include<iterator>
+#include<cstring>
+#include<cstdio>
+
+using namespace std;
+
+static int failures = 0;
+
+#define CHECK(condition) \
+	do { if (!(condition)) { cout << __FILE__ << ":" << __LINE__ << ": failed: " #condition << endl; failures++; } } while (0)
+
+//------------------------------------------------------------------------------
+static void edgeIndexClear()
+{
+	EdgeIndex index;
+	index.insert(1, 2, 7);
+	index.insert(3, 4, 8);
+	CHECK(index.find(1, 2) == 7);
+
+	index.clear();
+	CHECK(index.size() == 0);
+	CHECK(index.find(1, 2) == -1);
+	CHECK(index.find(3, 4) == -1);
+
+	// and still usable, including past a rebuild
+	for (int e = 0; e < 100; e++)
+		index.insert(e, e + 1, e);
+	CHECK(index.size() == 100);
+	CHECK(index.find(50, 51) == 50);
+	CHECK(index.find(1, 2) == 1);
+}
+//------------------------------------------------------------------------------
+static void loadTwoFiles()
+{
+	string first = "StorageTests_first.bgx", second = "StorageTests_second.bgx";
+
+	NiceGraph a;
+	a.makeEmptyGraph(4);
+	a.addEdge(0, 1);
+	a.addEdge(2, 3);
+	a.saveToFile(first);
+
+	NiceGraph b;
+	b.makeEmptyGraph(4);
+	b.addEdge(0, 1);
+	b.addEdge(1, 2);
+	b.saveToFile(second);
+
+	// the second load must not see anything left over from the first
+	NiceGraph g;
+	g.loadFromFile(first);
+	CHECK(g.getNumEdges() == 2);
+	g.loadFromFile(second);
+	CHECK(g.getNumVertices() == 4);
+	CHECK(g.getNumEdges() == 2);
+	CHECK(g.testFromToConnected(0, 1));
+	CHECK(g.testFromToConnected(1, 2));
+	CHECK(!g.testFromToConnected(2, 3));
+
+	remove(first.c_str());
+	remove(second.c_str());
+}
+//------------------------------------------------------------------------------
+static void undoMakeUndirected()
+{
+	// undo rebuilds the edge index with the directed keys
+	NiceGraph g;
+	g.makeEmptyGraph(3);
+	g.addEdge(2, 0);
+	g.makeUndirected();
+	CHECK(g.testFromToConnected(0, 2));
+
+	CHECK(g.undo());
+	CHECK(g.testFromToConnected(2, 0));
+	CHECK(!g.testFromToConnected(0, 2));
+}
+//------------------------------------------------------------------------------
+// for damaging mapped files: one value read from a file, or a copy of it
+// with one value written over
+template <class T>
+static T readValue(const string &file, long long at)
+{
+	T value;
+	ifstream in (file.c_str(), ios::binary);
+	in.seekg(at);
+	in.read((char *) &value, sizeof(T));
+	return value;
+}
+template <class T>
+static void damagedCopy(const string &file, const string &copy, long long at, T value)
+{
+	ifstream in (file.c_str(), ios::binary);
+	string bytes ((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+	memcpy(&bytes[at], &value, sizeof(T));
+	ofstream out (copy.c_str(), ios::binary | ios::trunc);
+	out.write(bytes.data(), bytes.size());
+}
+//------------------------------------------------------------------------------
+static void mappedFiles()
+{
+	string file = "StorageTests.bgcsr";
+
+	// a gap in the IDs, weights and positions that must all come back
+	NiceGraph g;
+	g.makeEmptyGraph(5);
+	g.addEdge(0, 1);
+	g.addEdge(1, 4);
+	g.addEdge(4, 0);
+	g.addEdges(vector<pair<int,int> >(1, make_pair(3, 4)), vector<float>(1, 2.5f));
+	g.setXYZPos(4, 1, 2, 3);
+	g.removeVertex(2);
+	CHECK(g.saveToMappedFile(file));
+
+	// the kernels run on the mapping just as on the snapshot it was written from
+	MappedGraph mapped;
+	CHECK(mapped.open(file));
+	const GraphSnapshot &snapshot = g.getSnapshot();
+	CHECK(mapped.getNumVertices() == snapshot.getNumVertices());
+	vector<float> fromMapped, fromSnapshot;
+	double residual;
+	GraphKernels::pageRank(mapped, fromMapped, 0.85f, 0, 30, residual);
+	GraphKernels::pageRank(snapshot, fromSnapshot, 0.85f, 0, 30, residual);
+	CHECK(fromMapped == fromSnapshot);
+	vector<int> hops;
+	GraphKernels::bfsDistances(mapped, snapshot.getDenseIndex(3), hops);
+	CHECK(hops[snapshot.getDenseIndex(1)] == 3);
+	mapped.close();
+
+	// the path measures count hops, like the snapshot's of an unweighted graph
+	string unitFile = "StorageTests_unit.bgcsr";
+	NiceGraph unit;
+	unit.makeRandomGraph(60, 0.05);
+	CHECK(unit.saveToMappedFile(unitFile));
+	CHECK(mapped.open(unitFile));
+	PathMetrics fromFile, fromGraph;
+	mapped.pathMetrics(fromFile);
+	unit.getSnapshot().pathMetrics(fromGraph);
+	CHECK(fromFile.sums == fromGraph.sums);
+	CHECK(fromFile.eccentricity == fromGraph.eccentricity);
+	CHECK(fromFile.histogram == fromGraph.histogram);
+	CHECK(fromFile.graphAvgPath == fromGraph.graphAvgPath);
+	mapped.close();
+	remove(unitFile.c_str());
+
+	NiceGraph loaded;
+	CHECK(loaded.loadFromMappedFile(file));
+	CHECK(loaded.getNumVertices() == 4);
+	CHECK(loaded.getNumEdges() == 4);
+	CHECK(!loaded.validVID(2));
+	CHECK(loaded.testFromToConnected(4, 0));
+	CHECK(!loaded.testFromToConnected(0, 4));
+	CHECK(loaded.getWeight(3, 4) == 2.5f);
+	CHECK(loaded.getXPositions()[4] == 1);
+	CHECK(!loaded.canUndo());
+
+	// an undirected edge is in both rows of the file but is one edge again
+	g.makeUndirected();
+	CHECK(g.saveToMappedFile(file));
+	CHECK(loaded.loadFromMappedFile(file));
+	CHECK(loaded.getNumEdges() == 4);
+	CHECK(loaded.testFromToConnected(0, 4));
+
+	CHECK(!loaded.loadFromMappedFile("StorageTests_missing.bgcsr"));
+
+	// nor a damaged one; the header has the vertex and arc counts at 16 and
+	// 24, then the section offsets from 32 on, in file order
+	string damaged = "StorageTests_damaged.bgcsr";
+	long long n = readValue<long long>(file, 16), m = readValue<long long>(file, 24);
+	long long outOffsetsAt = readValue<long long>(file, 32), outNeighborsAt = readValue<long long>(file, 40);
+	long long inOffsetsAt = readValue<long long>(file, 56), vidsAt = readValue<long long>(file, 72);
+	CHECK(mapped.open(file));
+	mapped.close();
+
+	damagedCopy(file, damaged, 40, 8LL);		// a section in the header
+	CHECK(!mapped.open(damaged));
+	damagedCopy(file, damaged, 48, readValue<long long>(file, 48) + 2);		// misaligned weights
+	CHECK(!mapped.open(damaged));
+	damagedCopy(file, damaged, 56, inOffsetsAt + 4);		// misaligned offsets
+	CHECK(!mapped.open(damaged));
+	damagedCopy(file, damaged, 56, -8LL);
+	CHECK(!mapped.open(damaged));
+	damagedCopy(file, damaged, outOffsetsAt, 1LL);		// offsets not starting at 0
+	CHECK(!mapped.open(damaged));
+	damagedCopy(file, damaged, inOffsetsAt + n * 8, m - 1);		// or not ending at the arc count
+	CHECK(!mapped.open(damaged));
+	damagedCopy(file, damaged, outOffsetsAt + 8, m);		// or going down
+	CHECK(!mapped.open(damaged));
+	damagedCopy(file, damaged, outNeighborsAt, (int) n);		// a neighbor that isn't a vertex
+	CHECK(!mapped.open(damaged));
+	damagedCopy(file, damaged, outNeighborsAt, -1);
+	CHECK(!mapped.open(damaged));
+	damagedCopy(file, damaged, vidsAt, -3);		// a negative ID
+	CHECK(!mapped.open(damaged));
+	CHECK(!loaded.loadFromMappedFile(damaged));
+	CHECK(!mapped.isOpen());
+
+	remove(damaged.c_str());
+	remove(file.c_str());
+}
+//------------------------------------------------------------------------------
+static void reusedVertexIDs()
+{
+	// a removed vertex's ID goes to the next one added, but a snapshot taken
+	// before can still tell them apart
+	NiceGraph g;
+	g.makeEmptyGraph(3);
+	shared_ptr<const GraphSnapshot> before = g.shareSnapshot();
+	int old = before->getDenseIndex(1);
+	g.removeVertex(1);
+	CHECK(g.addVertex() == 1);
+	CHECK(before->getDenseIndex(1) == old);
+	CHECK(before->getGeneration(old) != g.getVertexGeneration(1));
+	CHECK(before->getGeneration(before->getDenseIndex(2)) == g.getVertexGeneration(2));
+	CHECK(g.getSnapshot().getGeneration(g.getSnapshot().getDenseIndex(1)) == g.getVertexGeneration(1));
+}
+//------------------------------------------------------------------------------
+static void attributeVersions()
+{
+	// results tagged with the version must go stale when a value changes
+	NiceGraph g;
+	g.makeEmptyGraph(2);
+	g.addEdge(0, 1);
+	int vcol = g.getVertexAttributes().addColumn("weight", AttributeStore::FLOAT);
+	int ecol = g.getEdgeAttributes().addColumn("label", AttributeStore::STRING);
+
+	unsigned long version = g.getVersion();
+	g.setVertexAttribute(vcol, 1, "2.5");
+	CHECK(g.getVersion() != version);
+	version = g.getVersion();
+	g.setVertexAttribute(vcol, 1, "2.5");
+	CHECK(g.getVersion() == version);	// not a change
+	g.setEdgeAttribute(ecol, 0, "road");
+	CHECK(g.getVersion() != version);
+	version = g.getVersion();
+	CHECK(g.undo());
+	CHECK(g.getVersion() != version);
+}
+//------------------------------------------------------------------------------
+static void attributeFiles()
+{
+	// string values with the characters the file format uses itself
+	string file = "StorageTests_attributes.bgx";
+	NiceGraph g;
+	g.makeEmptyGraph(3);
+	g.addEdge(0, 1);
+	int vcol = g.getVertexAttributes().addColumn("note", AttributeStore::STRING);
+	int ecol = g.getEdgeAttributes().addColumn("label", AttributeStore::STRING);
+	string awkward = "two\nlines, a comma\\n and \\ a backslash\r";
+	g.setVertexAttribute(vcol, 1, awkward);
+	g.setVertexAttribute(vcol, 2, "#not a section");
+	g.setEdgeAttribute(ecol, 0, ",");
+	g.saveToFile(file);
+
+	NiceGraph loaded;
+	loaded.loadFromFile(file);
+	vcol = loaded.getVertexAttributes().findColumn("note");
+	ecol = loaded.getEdgeAttributes().findColumn("label");
+	CHECK(loaded.getVertexAttributes().getString(vcol, 1) == awkward);
+	CHECK(loaded.getVertexAttributes().getString(vcol, 2) == "#not a section");
+	CHECK(loaded.getEdgeAttributes().getString(ecol, 0) == ",");
+	remove(file.c_str());
+}
+//------------------------------------------------------------------------------
+static void removedColumns()
+{
+	// changes journaled before a column went must still find the others
+	NiceGraph g;
+	g.makeEmptyGraph(2);
+	AttributeStore &store = g.getVertexAttributes();
+	int first = store.addColumn("first", AttributeStore::INT32);
+	int second = store.addColumn("second", AttributeStore::INT32);
+	g.setVertexAttribute(first, 0, "1");
+	g.setVertexAttribute(second, 0, "2");
+	g.setVertexAttribute(second, 1, "3");
+	g.removeVertex(1);
+
+	store.removeColumn(first);
+	second = store.findColumn("second");
+	CHECK(g.undo());	// the removed vertex, with its value in the right column
+	CHECK(store.getNumber(second, 1) == 3);
+	CHECK(g.undo());
+	CHECK(store.getNumber(second, 1) == 0);
+	CHECK(store.getNumber(second, 0) == 2);
+	CHECK(g.undo());
+	CHECK(store.getNumber(second, 0) == 0);
+	CHECK(g.undo());	// to the column that is gone, so nothing
+	CHECK(store.getNumColumns() == 1);
+}
+//------------------------------------------------------------------------------
+static void compressedRows()
+{
+	// the packed rows must give the analyses exactly what the plain ones do
+	NiceGraph g;
+	g.makeRandomGraph(300, 0.05);
+	g.removeVertex(7);
+	g.makeUndirected();
+	const GraphSnapshot &plain = g.getSnapshot();
+	CHECK(plain.getCompressedGraph() == NULL);
+
+	CompressedGraph packed;
+	packed.build(plain);
+	CHECK(packed.getNumVertices() == plain.getNumVertices());
+	CHECK(packed.bytesPerEdge() > 0);
+	vector<float> fromPacked, fromPlain;
+	double residual;
+	GraphKernels::pageRank(packed, fromPacked, 0.85f, 0, 30, residual);
+	GraphKernels::pageRank(plain, fromPlain, 0.85f, 0, 30, residual);
+	CHECK(fromPacked == fromPlain);
+	vector<int> hopsPacked, hopsPlain;
+	GraphKernels::bfsDistances(packed, 0, hopsPacked);
+	GraphKernels::bfsDistances(plain, 0, hopsPlain);
+	CHECK(hopsPacked == hopsPlain);
+	CHECK(GraphKernels::countTriangles(packed) == GraphKernels::countTriangles(plain));
+
+	// and likewise through the snapshot once the option is on
+	long long triangles = plain.countTriangles();
+	plain.pageRank(fromPlain);
+	plain.bfsDistances(5, hopsPlain);
+	unsigned long version = g.getVersion();
+	g.setCompressedRows(true);
+	CHECK(g.getVersion() == version);
+	const GraphSnapshot &withPacked = g.getSnapshot();
+	CHECK(withPacked.getCompressedGraph() != NULL);
+	CHECK(withPacked.countTriangles() == triangles);
+	withPacked.pageRank(fromPacked);
+	CHECK(fromPacked == fromPlain);
+	withPacked.bfsDistances(5, hopsPacked);
+	CHECK(hopsPacked == hopsPlain);
+
+	g.setCompressedRows(false);
+	CHECK(g.getSnapshot().getCompressedGraph() == NULL);
+}
+//------------------------------------------------------------------------------
+static void weightedPaths()
+{
+	// weighted distances get no histogram, however long they are
+	NiceGraph g;
+	g.makeEmptyGraph(4);
+	vector<pair<int,int> > edges;
+	edges.push_back(make_pair(0, 1));
+	edges.push_back(make_pair(1, 2));
+	edges.push_back(make_pair(2, 3));
+	vector<float> weights;
+	weights.push_back(1e9f);
+	weights.push_back(2.5f);
+	weights.push_back(3e9f);
+	g.addEdges(edges, weights);
+	PathMetrics metrics;
+	CHECK(g.getSnapshot().pathMetrics(metrics));
+	CHECK(metrics.histogram.empty());
+	CHECK(metrics.diameter > 3.9e9f);
+
+	// and a negative weight is turned away before any search
+	weights[1] = -2;
+	NiceGraph negative;
+	negative.makeEmptyGraph(4);
+	negative.addEdges(edges, weights);
+	CHECK(!negative.getSnapshot().pathMetrics(metrics));
+	CHECK(metrics.reached[0] == 0);
+	CHECK(metrics.graphAvgPath == -1);
+	CHECK(metrics.histogram.empty());
+}
+//------------------------------------------------------------------------------
+static void relatedVertices()
+{
+	NiceGraph g;
+	g.makeEmptyGraph(3);
+	g.addEdge(0, 1);
+	g.addEdge(1, 2);
+	vector<pair<int,float> > related;
+	g.getRelatedVertices(0, 2, related);
+	CHECK(related.size() == 2);
+	g.getRelatedVertices(0, -1, related);
+	CHECK(related.empty());
+}
+//------------------------------------------------------------------------------
+int main()
+{
+	edgeIndexClear();
+	loadTwoFiles();
+	undoMakeUndirected();
+	mappedFiles();
+	reusedVertexIDs();
+	attributeVersions();
+	attributeFiles();
+	removedColumns();
+	compressedRows();
+	weightedPaths();
+	relatedVertices();
+
+	if (failures)
+		cout << failures << " check(s) failed" << endl;
+	else
+		cout << "all passed" << endl;
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,34 @@
+######################################################################
+# Checks of the non-GUI parts of BabelGraph; no Qt needed.
+#	qmake && make && ./StorageTests
+######################################################################
+
+TEMPLATE = app
+TARGET = StorageTests
+CONFIG += console
+CONFIG -= qt app_bundle
+DEPENDPATH += ..
+INCLUDEPATH += ..
+
+unix|win32-g++ {
+    QMAKE_CXXFLAGS += -fopenmp
+    LIBS += -fopenmp
+}
+win32-msvc* {
+    QMAKE_CXXFLAGS += -openmp
+}
+
+SOURCES += StorageTests.cpp \
+           ../NiceGraph.cpp \
+           ../GraphSnapshot.cpp \
+           ../EdgeIndex.cpp \
+           ../PositionBuffer.cpp \
+           ../StringPool.cpp \
+           ../AttributeStore.cpp \
+           ../CompressedGraph.cpp \
+           ../MappedGraph.cpp \
+           ../GraphJournal.cpp \
+           ../BitMatrix.cpp \
+           ../DistanceMatrix.cpp \
+           ../PersonalizedPageRank.cpp \
+           ../IncrementalPageRank.cpp